@@ -6,14 +6,9 @@
 #define TZOZEN_IMPLEMENTATION
 #include "./tzozen_dump.h"
 
-#define MEMORY_CAPACITY (100 * 1000 * 1000)
 #define ARRAY_SIZE(xs) (sizeof(xs) / sizeof((xs)[0]))
 
-uint8_t memory_buffer[MEMORY_CAPACITY];
-Tzozen_Memory memory = {
-    .capacity = MEMORY_CAPACITY,
-    .buffer = memory_buffer,
-};
+Tzozen_Memory memory;
 
 void usage(FILE *stream)
 {
@@ -39,7 +34,22 @@ int main(int argc, char *argv[])
 
     Tzozen_Str input = read_file_as_string(input_file_path);
 
-    Json_Value *index = memory_alloc(&memory, sizeof(Json_Value));
+    // The dump is the whole memory, so it is allocated exactly
+    size_t size = 0;
+    Json_Result measured = json_measure(input, NULL, &size, NULL);
+    if (measured.is_error) {
+        print_json_error(stderr, measured, input, input_file_path);
+        exit(1);
+    }
+
+    size += sizeof(Json_Value);
+    memory = tzozen_memory(calloc(size, 1), size);
+    if (memory.buffer == NULL) {
+        fprintf(stderr, "Could not allocate %zu bytes for `%s`\n", size, input_file_path);
+        exit(1);
+    }
+
+    Json_Value *index = TZOZEN_ALLOC(&memory, Json_Value, 1);
 
     Json_Result result = parse_json_value(&memory, input);
     if (result.is_error) {
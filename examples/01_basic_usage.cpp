@@ -7,10 +7,7 @@ static uint8_t memory_buffer[MEMORY_CAPACITY];
 
 int main()
 {
-    Tzozen_Memory memory;
-    memory.capacity = MEMORY_CAPACITY;
-    memory.size = 0;
-    memory.buffer = memory_buffer;
+    Tzozen_Memory memory = tzozen_memory(memory_buffer, MEMORY_CAPACITY);
 
     Tzozen_Str input =
         TSTR("{\n"
@@ -0,0 +1,120 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TZOZEN_STATIC
+#define TZOZEN_IMPLEMENTATION
+#include "./tzozen.h"
+
+#define DEFAULT_INDENT 2
+#define OUTPUT_CAPACITY (64 * 1024)
+// Only the strings with escape sequences go there, one at a time
+#define SCRATCH_CAPACITY (1000 * 1000)
+#define SCRATCH_BLOCK_SIZE (16 * 1000 * 1000)
+#define STACK_CAPACITY 1024
+
+char output_buffer[OUTPUT_CAPACITY];
+uint8_t scratch_buffer[SCRATCH_CAPACITY];
+Json_Frame stack[STACK_CAPACITY];
+
+void usage(FILE *stream)
+{
+    fprintf(stream, "Usage: format_json [-m] [-i <width>] <input.json>\n");
+    fprintf(stream, "   -m                Minify the document\n");
+    fprintf(stream, "   -i <width>        Indent every level by <width> spaces (default %d)\n", DEFAULT_INDENT);
+    fprintf(stream, "   input.json        The document is streamed to stdout without building its tree\n");
+}
+
+void *scratch_alloc(void *data, size_t size)
+{
+    (void) data;
+    return malloc(size);
+}
+
+void scratch_free(void *data, void *block, size_t size)
+{
+    (void) data;
+    (void) size;
+    free(block);
+}
+
+const Tzozen_Allocator scratch_allocator = {
+    .alloc = scratch_alloc,
+    .free = scratch_free,
+};
+
+int main(int argc, char *argv[])
+{
+    size_t indent = DEFAULT_INDENT;
+    const char *input_file_path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-m") == 0) {
+            indent = 0;
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            indent = strtoul(argv[++i], NULL, 10);
+        } else {
+            input_file_path = argv[i];
+        }
+    }
+
+    if (input_file_path == NULL) {
+        fprintf(stderr, "[ERROR] Not enough arguments!\n");
+        usage(stderr);
+        exit(1);
+    }
+
+    int fd = open(input_file_path, O_RDONLY);
+    struct stat statbuf;
+    if (fd < 0 || fstat(fd, &statbuf) < 0) {
+        fprintf(stderr, "Could not open file `%s`: %s\n", input_file_path, strerror(errno));
+        exit(1);
+    }
+
+    Tzozen_Str input = {(size_t) statbuf.st_size, NULL};
+    if (input.len > 0) {
+        void *data = mmap(NULL, input.len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            fprintf(stderr, "Could not map file `%s`: %s\n", input_file_path, strerror(errno));
+            exit(1);
+        }
+        input.data = data;
+        // The document is read once from the beginning to the end
+        posix_madvise(data, input.len, POSIX_MADV_SEQUENTIAL);
+    }
+
+    // A huge escaped string takes a block of its own
+    Tzozen_Memory scratch = tzozen_memory_chained(scratch_buffer, SCRATCH_CAPACITY,
+                                                  &scratch_allocator, SCRATCH_BLOCK_SIZE);
+
+    Json_Options options = {0};
+    options.stack = stack;
+    options.stack_capacity = STACK_CAPACITY;
+
+    Json_Sink sink = json_sink_file(stdout, output_buffer, OUTPUT_CAPACITY);
+    Json_Result result = json_reformat(&scratch, input, &options, indent, &sink);
+    if (!result.is_error && tzozen_str_trim_begin(result.rest).len > 0) {
+        result.is_error = 1;
+        result.rest = tzozen_str_trim_begin(result.rest);
+        result.message = "Expected EOF";
+    }
+
+    json_sink_putc(&sink, '\n');
+    if (json_sink_flush(&sink) < 0 && !result.is_error) {
+        fprintf(stderr, "Could not write the output: %s\n", strerror(errno));
+        exit(1);
+    }
+
+    if (result.is_error) {
+        fflush(stdout);
+        print_json_error(stderr, result, input, input_file_path);
+        exit(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,382 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TZOZEN_STATIC
+#define TZOZEN_IMPLEMENTATION
+#include "./tzozen.h"
+
+#define MAX_THREADS 256
+#define DEFAULT_THREADS 4
+// Amount of input in a job. The lines are never cut between the jobs.
+#define JOB_SIZE (1 * 1000 * 1000)
+// Jobs waiting for a worker or for their output to be written. Keeps
+// the output that is held in memory bounded.
+#define JOBS_PER_THREAD 2
+#define JOBS_CAPACITY (JOBS_PER_THREAD * MAX_THREADS)
+// Enough for the common case. Bigger values chain more blocks of
+// WORKER_BLOCK_SIZE and give them back when they are printed.
+#define WORKER_MEMORY_CAPACITY (16 * 1000 * 1000)
+#define WORKER_BLOCK_SIZE (16 * 1000 * 1000)
+#define LINES_CAPACITY 1024
+
+typedef struct {
+    Tzozen_Str chunk;
+    // Number of the first line of the chunk in the input
+    size_t first_line;
+    int done;
+
+    char *output;
+    size_t output_size;
+    char *errors;
+    size_t errors_size;
+    size_t errors_count;
+} Job;
+
+typedef struct {
+    pthread_t thread;
+
+    // The slice of the array and the result of parsing it with -a
+    Tzozen_Str chunk;
+    Json_Result result;
+
+    Tzozen_Memory memory;
+    Json_Line lines[LINES_CAPACITY];
+} Worker;
+
+Worker workers[MAX_THREADS];
+const char *input_file_path = NULL;
+
+// Ring of the jobs. The workers take them in order starting from
+// `jobs_taken`, the main thread writes their output in order starting
+// from `jobs_written` and queues the new ones at `jobs_queued`.
+Job jobs[JOBS_CAPACITY];
+size_t jobs_capacity;
+size_t jobs_written;
+size_t jobs_taken;
+size_t jobs_queued;
+int input_over;
+pthread_mutex_t jobs_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t jobs_queued_cond = PTHREAD_COND_INITIALIZER;
+pthread_cond_t jobs_done_cond = PTHREAD_COND_INITIALIZER;
+
+void usage(FILE *stream)
+{
+    fprintf(stream, "Usage: parse_parallel [-j <threads>] [-a] <input.jsonl>\n");
+    fprintf(stream, "   -j <threads>      Amount of worker threads (default %d)\n", DEFAULT_THREADS);
+    fprintf(stream, "   -a                The input is a single huge array. Its elements are parsed in parallel\n");
+    fprintf(stream, "   input.jsonl       JSON Lines file. Every value is printed on its own line\n");
+}
+
+size_t count_lines(const char *begin, const char *end)
+{
+    size_t count = 0;
+    while ((begin = memchr(begin, '\n', end - begin)) != NULL) {
+        count += 1;
+        begin += 1;
+    }
+    return count;
+}
+
+void *worker_alloc(void *data, size_t size)
+{
+    (void) data;
+    return malloc(size);
+}
+
+void worker_free(void *data, void *block, size_t size)
+{
+    (void) data;
+    (void) size;
+    free(block);
+}
+
+const Tzozen_Allocator worker_allocator = {
+    .alloc = worker_alloc,
+    .free = worker_free,
+};
+
+void run_job(Worker *worker, Job *job)
+{
+    FILE *output = open_memstream(&job->output, &job->output_size);
+    FILE *errors = open_memstream(&job->errors, &job->errors_size);
+    if (output == NULL || errors == NULL) {
+        fprintf(stderr, "Could not create the output of a worker: %s\n", strerror(errno));
+        exit(1);
+    }
+
+    Tzozen_Str source = job->chunk;
+    size_t line_number = job->first_line;
+    const char *counted = source.data;
+
+    while (source.len > 0) {
+        size_t n = parse_json_lines(&worker->memory, &source, NULL, worker->lines, LINES_CAPACITY);
+
+        for (size_t i = 0; i < n; ++i) {
+            Json_Line *line = &worker->lines[i];
+            line_number += count_lines(counted, line->line.data);
+            counted = line->line.data;
+
+            if (line->result.is_error) {
+                fprintf(errors, "%s:%zu:%zu: %s\n",
+                        input_file_path,
+                        line_number,
+                        (size_t) (line->result.rest.data - line->line.data) + 1,
+                        line->result.message);
+                job->errors_count += 1;
+            } else {
+                print_json_value(output, line->result.value);
+                fputc('\n', output);
+            }
+        }
+
+        // Everything is printed already
+        tzozen_memory_reset(&worker->memory);
+    }
+
+    fclose(output);
+    fclose(errors);
+}
+
+void *worker_run(void *arg)
+{
+    Worker *worker = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&jobs_mutex);
+        while (jobs_taken == jobs_queued && !input_over) {
+            pthread_cond_wait(&jobs_queued_cond, &jobs_mutex);
+        }
+        if (jobs_taken == jobs_queued) {
+            pthread_mutex_unlock(&jobs_mutex);
+            return NULL;
+        }
+        Job *job = &jobs[jobs_taken++ % jobs_capacity];
+        pthread_mutex_unlock(&jobs_mutex);
+
+        run_job(worker, job);
+
+        pthread_mutex_lock(&jobs_mutex);
+        job->done = 1;
+        pthread_cond_signal(&jobs_done_cond);
+        pthread_mutex_unlock(&jobs_mutex);
+    }
+}
+
+void *worker_run_array(void *arg)
+{
+    Worker *worker = arg;
+    worker->result = parse_json_elements(&worker->memory, worker->chunk, NULL);
+    return NULL;
+}
+
+void report_error(Tzozen_Str input, Json_Result result)
+{
+    const char *line = input.data;
+    size_t line_number = 1;
+    for (const char *at = input.data; at < result.rest.data; ++at) {
+        if (*at == '\n') {
+            line_number += 1;
+            line = at + 1;
+        }
+    }
+
+    fprintf(stderr, "%s:%zu:%zu: %s\n",
+            input_file_path,
+            line_number,
+            (size_t) (result.rest.data - line) + 1,
+            result.message);
+}
+
+int parse_array(Tzozen_Str input, size_t threads)
+{
+    Tzozen_Str slices[MAX_THREADS];
+    size_t n = 0;
+
+    Json_Result split = json_array_split(input, slices, threads, &n);
+    if (split.is_error) {
+        report_error(input, split);
+        return 1;
+    }
+
+    if (tzozen_str_trim_begin(split.rest).len > 0) {
+        split.rest = tzozen_str_trim_begin(split.rest);
+        split.message = "Expected EOF";
+        report_error(input, split);
+        return 1;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        workers[i].chunk = slices[i];
+
+        if (pthread_create(&workers[i].thread, NULL, worker_run_array, &workers[i]) != 0) {
+            fprintf(stderr, "Could not create a worker thread\n");
+            exit(1);
+        }
+    }
+
+    // The slices are linked in the original order, every worker
+    // memory keeps its part of the array
+    Json_Array array = {0};
+    int failed = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        pthread_join(workers[i].thread, NULL);
+
+        if (workers[i].result.is_error) {
+            if (!failed) report_error(input, workers[i].result);
+            failed = 1;
+        } else {
+            json_array_concat(&array, workers[i].result.value.array);
+        }
+    }
+
+    if (failed) {
+        return 1;
+    }
+
+    print_json_value(stdout, json_array(array));
+    fputc('\n', stdout);
+
+    return 0;
+}
+
+int parse_lines(Tzozen_Str input, size_t threads)
+{
+    jobs_capacity = JOBS_PER_THREAD * threads;
+
+    for (size_t i = 0; i < threads; ++i) {
+        if (pthread_create(&workers[i].thread, NULL, worker_run, &workers[i]) != 0) {
+            fprintf(stderr, "Could not create a worker thread\n");
+            exit(1);
+        }
+    }
+
+    // The workers only touch a job after it is queued, so the next one
+    // is prepared without the lock
+    size_t line_number = 1;
+    size_t errors_count = 0;
+
+    pthread_mutex_lock(&jobs_mutex);
+    for (;;) {
+        while (input.len > 0 && jobs_queued - jobs_written < jobs_capacity) {
+            Job *job = &jobs[jobs_queued % jobs_capacity];
+            pthread_mutex_unlock(&jobs_mutex);
+
+            Tzozen_Str chunk = input;
+            if (chunk.len > JOB_SIZE) {
+                const char *newline = memchr(input.data + JOB_SIZE, '\n', input.len - JOB_SIZE);
+                if (newline != NULL) {
+                    chunk.len = newline - input.data + 1;
+                }
+            }
+            tzozen_str_chop(&input, chunk.len);
+
+            memset(job, 0, sizeof(*job));
+            job->chunk = chunk;
+            job->first_line = line_number;
+            line_number += count_lines(chunk.data, chunk.data + chunk.len);
+
+            pthread_mutex_lock(&jobs_mutex);
+            jobs_queued += 1;
+            pthread_cond_signal(&jobs_queued_cond);
+        }
+
+        if (input.len == 0 && !input_over) {
+            input_over = 1;
+            pthread_cond_broadcast(&jobs_queued_cond);
+        }
+
+        if (jobs_written == jobs_queued) {
+            break;
+        }
+
+        // The output goes in the order of the input
+        Job *job = &jobs[jobs_written % jobs_capacity];
+        while (!job->done) {
+            pthread_cond_wait(&jobs_done_cond, &jobs_mutex);
+        }
+        pthread_mutex_unlock(&jobs_mutex);
+
+        fwrite(job->output, 1, job->output_size, stdout);
+        fwrite(job->errors, 1, job->errors_size, stderr);
+        errors_count += job->errors_count;
+        free(job->output);
+        free(job->errors);
+
+        pthread_mutex_lock(&jobs_mutex);
+        jobs_written += 1;
+    }
+    pthread_mutex_unlock(&jobs_mutex);
+
+    for (size_t i = 0; i < threads; ++i) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    return errors_count > 0;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t threads = DEFAULT_THREADS;
+    int array_mode = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = strtoul(argv[++i], NULL, 10);
+            if (threads == 0 || threads > MAX_THREADS) {
+                fprintf(stderr, "[ERROR] Amount of threads must be between 1 and %d\n", MAX_THREADS);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "-a") == 0) {
+            array_mode = 1;
+        } else {
+            input_file_path = argv[i];
+        }
+    }
+
+    if (input_file_path == NULL) {
+        fprintf(stderr, "[ERROR] Not enough arguments!\n");
+        usage(stderr);
+        exit(1);
+    }
+
+    int fd = open(input_file_path, O_RDONLY);
+    struct stat statbuf;
+    if (fd < 0 || fstat(fd, &statbuf) < 0) {
+        fprintf(stderr, "Could not open file `%s`: %s\n", input_file_path, strerror(errno));
+        exit(1);
+    }
+
+    Tzozen_Str input = {(size_t) statbuf.st_size, NULL};
+    if (input.len > 0) {
+        void *data = mmap(NULL, input.len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            fprintf(stderr, "Could not map file `%s`: %s\n", input_file_path, strerror(errno));
+            exit(1);
+        }
+        input.data = data;
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        uint8_t *buffer = malloc(WORKER_MEMORY_CAPACITY);
+        workers[i].memory = tzozen_memory_chained(buffer, WORKER_MEMORY_CAPACITY,
+                                                  &worker_allocator, WORKER_BLOCK_SIZE);
+        if (buffer == NULL) {
+            fprintf(stderr, "Could not allocate memory for the workers\n");
+            exit(1);
+        }
+    }
+
+    if (array_mode) {
+        return parse_array(input, threads);
+    }
+
+    return parse_lines(input, threads);
+}
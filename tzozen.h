@@ -15,8 +15,11 @@
 
 // NOTES:
 // - Define TZOZEN_NO_STDIO to remove all the code that uses stdio.h
+// - Define TZOZEN_NO_SIMD to use only the portable scalar code even if
+//   the compiler targets SSE2/AVX2
 
 #include <assert.h>
+#include <float.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -24,6 +27,20 @@
 #include <stdio.h>
 #endif // TZOZEN_NO_STDIO
 
+#ifndef TZOZEN_NO_SIMD
+#    if defined(__AVX2__)
+#        define TZOZEN_AVX2
+#        include <immintrin.h>
+#    elif defined(__SSE2__) || defined(_M_X64)
+#        define TZOZEN_SSE2
+#        include <emmintrin.h>
+#    endif
+#endif // TZOZEN_NO_SIMD
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#    define TZOZEN_LITTLE_ENDIAN
+#endif
+
 #ifndef TZOZENDEF
 #    ifdef TZOZEN_STATIC
 #        define TZOZENDEF static
@@ -32,15 +49,70 @@
 #    endif
 #endif
 
+typedef struct {
+    // Returns a block of `size` bytes or NULL
+    void *(*alloc)(void *data, size_t size);
+    // Gives back a block returned by `alloc`. May be NULL.
+    void (*free)(void *data, void *block, size_t size);
+    void *data;
+} Tzozen_Allocator;
+
+typedef struct Tzozen_Memory_Block Tzozen_Memory_Block;
+
 typedef struct {
     size_t capacity;
     size_t size;
     uint8_t *buffer;
+
+    // When the allocator is set and the buffer is full, the memory
+    // chains a new block of at least `block_size` bytes from it and
+    // continues there. Without the allocator the memory is just the
+    // fixed buffer.
+    const Tzozen_Allocator *allocator;
+    size_t block_size;
+    // The chained block of the buffer. NULL for the initial buffer.
+    Tzozen_Memory_Block *block;
+    // The last block given back by a rollback. It is reused by the next
+    // chaining, so an arena that is reset between documents stays warm.
+    Tzozen_Memory_Block *spare;
 } Tzozen_Memory;
 
+// A point in the memory to roll back to
+typedef struct {
+    uint8_t *buffer;
+    size_t size;
+} Tzozen_Memory_Mark;
+
 TZOZENDEF Tzozen_Memory tzozen_memory(uint8_t *buffer, size_t capacity);
+// The buffer may be NULL, then the first allocation chains a block
+TZOZENDEF Tzozen_Memory tzozen_memory_chained(uint8_t *buffer, size_t capacity,
+                                              const Tzozen_Allocator *allocator,
+                                              size_t block_size);
+// Gives all the chained blocks back to the allocator and empties the memory
+TZOZENDEF void tzozen_memory_free(Tzozen_Memory *memory);
+TZOZENDEF Tzozen_Memory_Mark tzozen_memory_save(const Tzozen_Memory *memory);
+// Forgets everything allocated after the mark was saved
+TZOZENDEF void tzozen_memory_rollback(Tzozen_Memory *memory, Tzozen_Memory_Mark mark);
+// Empties the memory, but keeps the biggest chained block for reuse
+TZOZENDEF void tzozen_memory_reset(Tzozen_Memory *memory);
 
 TZOZENDEF void *memory_alloc(Tzozen_Memory *memory, size_t size);
+// The alignment must be a power of two
+TZOZENDEF void *memory_alloc_aligned(Tzozen_Memory *memory, size_t size, size_t alignment);
+
+#ifdef __cplusplus
+#    define TZOZEN_ALIGNOF(type) alignof(type)
+#else
+#    define TZOZEN_ALIGNOF(type) _Alignof(type)
+#endif
+
+// Allocates `count` properly aligned objects of the `type`
+#define TZOZEN_ALLOC(memory, type, count) \
+    ((type *) memory_alloc_aligned((memory), sizeof(type) * (count), TZOZEN_ALIGNOF(type)))
+// Grows the run of bytes from `begin` up to the end of the memory by
+// `size` bytes. If the run does not fit into the buffer anymore, it is
+// moved to a new block. Returns the beginning of the run or NULL.
+TZOZENDEF void *memory_extend(Tzozen_Memory *memory, void *begin, size_t size);
 
 #define UTF8_CHUNK_CAPACITY 4
 typedef struct {
@@ -71,6 +143,7 @@ TZOZENDEF Tzozen_Str tzozen_str_drop(Tzozen_Str s, size_t n);
 TZOZENDEF int tzozen_str_prefix_of(Tzozen_Str prefix, Tzozen_Str s);
 TZOZENDEF Tzozen_Str tzozen_str_trim_begin(Tzozen_Str s);
 TZOZENDEF int64_t tzozen_str_stoi64(Tzozen_Str integer);
+TZOZENDEF int tzozen_str_stoi64_checked(Tzozen_Str integer, int64_t *result);
 TZOZENDEF int tzozen_str_clone(Tzozen_Memory *memory, Tzozen_Str string, Tzozen_Str *clone);
 
 TZOZENDEF int32_t json_unhex(char x);
@@ -99,20 +172,58 @@ typedef struct Json_Array_Elem Json_Array_Elem;
 typedef struct {
     Json_Array_Elem *begin;
     Json_Array_Elem *end;
+    size_t size;
+    // Optional contiguous vector of all the `size` elements built by
+    // json_array_finalize(). NULL if not built or invalidated by a push.
+    Json_Array_Elem **elems;
 } Json_Array;
 
 TZOZENDEF size_t json_array_size(Json_Array array);
 TZOZENDEF int json_array_push(Tzozen_Memory *memory, Json_Array *array, Json_Value value);
+TZOZENDEF int json_array_finalize(Tzozen_Memory *memory, Json_Array *array);
+TZOZENDEF Json_Value json_array_at(Json_Array array, size_t i);
 
 typedef struct Json_Object_Elem Json_Object_Elem;
 
+// Key of the SipHash-1-3 used by the object hash tables. Pick it
+// randomly per process if the keys come from an untrusted source,
+// otherwise an attacker can craft keys that all collide.
+typedef struct {
+    uint64_t k0;
+    uint64_t k1;
+} Json_Hash_Seed;
+
+typedef struct {
+    uint64_t hash;
+    Json_Object_Elem *elem;
+} Json_Object_Slot;
+
+// Open addressing (linear probing) hash table of the object keys.
+// Only the last element of every duplicated key is in the table.
+typedef struct {
+    Json_Hash_Seed seed;
+    size_t capacity;
+    Json_Object_Slot *slots;
+} Json_Object_Table;
+
 typedef struct {
     Json_Object_Elem *begin;
     Json_Object_Elem *end;
+    size_t size;
+    // Same as Json_Array.elems
+    Json_Object_Elem **elems;
+    // Optional hash table built by json_object_hash(). NULL if not
+    // built or invalidated by a push.
+    Json_Object_Table *table;
 } Json_Object;
 
 TZOZENDEF size_t json_object_size(Json_Object object);
 TZOZENDEF int json_object_push(Tzozen_Memory *memory, Json_Object *object, Tzozen_Str key, Json_Value value);
+TZOZENDEF int json_object_finalize(Tzozen_Memory *memory, Json_Object *object);
+TZOZENDEF Json_Object_Elem *json_object_at(Json_Object object, size_t i);
+TZOZENDEF uint64_t json_hash(Json_Hash_Seed seed, Tzozen_Str key);
+TZOZENDEF int json_object_hash(Tzozen_Memory *memory, Json_Object *object, Json_Hash_Seed seed);
+// If the key is duplicated the value of the last one is returned
 TZOZENDEF Json_Value json_object_value_by_key(Json_Object object, Tzozen_Str key);
 
 typedef struct {
@@ -125,6 +236,8 @@ typedef struct {
 } Json_Number;
 
 TZOZENDEF int64_t json_number_to_integer(Json_Number number);
+TZOZENDEF int json_number_to_integer_checked(Json_Number number, int64_t *result);
+TZOZENDEF double json_number_to_double(Json_Number number);
 
 struct Json_Value {
     Json_Type type;
@@ -148,6 +261,9 @@ TZOZENDEF Json_Value json_array(Json_Array array);
 TZOZENDEF Json_Value json_object_empty();
 TZOZENDEF Json_Value json_object(Json_Object object);
 
+// Builds the element vectors of all the arrays and objects in the value
+TZOZENDEF int json_value_finalize(Tzozen_Memory *memory, Json_Value *value);
+
 struct Json_Array_Elem {
     Json_Array_Elem *next;
     Json_Value value;
@@ -174,18 +290,465 @@ typedef struct {
 TZOZENDEF Json_Result result_success(Tzozen_Str rest, Json_Value value);
 TZOZENDEF Json_Result result_failure(Tzozen_Str rest, const char *message);
 
+// Classification of a 64 byte block of the input. Bit i of every mask
+// corresponds to the i-th byte of the block.
+typedef struct {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t whitespace;
+    uint64_t structural;
+} Json_Block_Masks;
+
+TZOZENDEF Json_Block_Masks json_classify_block(const char *block);
+TZOZENDEF size_t json_string_scan(const char *data, size_t len);
+
+typedef struct {
+    uint64_t hash;
+    Tzozen_Str string;
+} Json_Intern_Slot;
+
+// Fixed capacity table of the strings seen during parsing. Identical
+// strings that go through the same table share a single copy, so they
+// can be compared by their `data` pointers. Once the table is 3/4 full
+// the new strings are not interned anymore.
+typedef struct {
+    Json_Hash_Seed seed;
+    size_t capacity;
+    size_t size;
+    Json_Intern_Slot *slots;
+    // String values (not keys) of at most that many bytes are interned
+    // too. 0 interns only the keys.
+    size_t max_value_len;
+} Json_Intern;
+
+TZOZENDEF int json_intern_init(Tzozen_Memory *memory, Json_Intern *intern, size_t capacity, Json_Hash_Seed seed);
+TZOZENDEF Tzozen_Str json_intern(Json_Intern *intern, Tzozen_Str string);
+
+// An array or an object that is being parsed
+typedef struct {
+    Json_Value container;
+    // The key of the member that is being parsed (objects only)
+    Tzozen_Str key;
+} Json_Frame;
+
+typedef struct {
+    // Numbers, and strings and keys without escape sequences, point
+    // straight into the source instead of being copied to the memory.
+    // The source must outlive the parsed values. Such values can't be
+    // dumped with tzozen_dump.h since they don't live in the memory.
+    int borrow_source;
+
+    // Build the element vectors of the arrays and objects while
+    // parsing (see json_array_finalize()).
+    int finalize_containers;
+
+    // Objects with at least that many members get a hash table keyed
+    // by `hash_seed` while parsing (see json_object_hash()). 0 disables
+    // it. Something around 16 is where the tables start to pay off.
+    size_t hash_threshold;
+    Json_Hash_Seed hash_seed;
+
+    // Optional table initialized by json_intern_init() to share the
+    // copies of the repeated keys and short string values. The table
+    // can be reused across several parses into the same memory.
+    Json_Intern *intern;
+
+    // Optional stack for the parser. Its capacity is the max depth of
+    // the documents. Without it the parser keeps JSON_DEPTH_MAX_LIMIT
+    // frames on the C stack.
+    Json_Frame *stack;
+    size_t stack_capacity;
+
+    // Optional memory for the bytes of the strings and the numbers.
+    // Keeps the nodes of the tree densely packed in the main memory.
+    Tzozen_Memory *bytes;
+} Json_Options;
+
 
 TZOZENDEF Json_Result parse_token(Tzozen_Str source, Tzozen_Str token, Json_Value value, const char *message);
 TZOZENDEF Json_Result parse_json_number(Tzozen_Memory *memory, Tzozen_Str source);
+TZOZENDEF Json_Result parse_json_number_with_options(Tzozen_Memory *memory, Tzozen_Str source, const Json_Options *options);
 TZOZENDEF Json_Result parse_escape_sequence(Tzozen_Memory *memory, Tzozen_Str source);
 TZOZENDEF Json_Result parse_json_string_literal(Tzozen_Str source);
 TZOZENDEF Json_Result parse_json_string(Tzozen_Memory *memory, Tzozen_Str source);
+TZOZENDEF Json_Result parse_json_string_with_options(Tzozen_Memory *memory, Tzozen_Str source, const Json_Options *options);
 TZOZENDEF Json_Result parse_json_array(Tzozen_Memory *memory, Tzozen_Str source, int level);
+TZOZENDEF Json_Result parse_json_array_with_options(Tzozen_Memory *memory, Tzozen_Str source, int level, const Json_Options *options);
 TZOZENDEF Json_Result parse_json_object(Tzozen_Memory *memory, Tzozen_Str source, int level);
+TZOZENDEF Json_Result parse_json_object_with_options(Tzozen_Memory *memory, Tzozen_Str source, int level, const Json_Options *options);
 TZOZENDEF Json_Result parse_json_value_with_depth(Tzozen_Memory *memory, Tzozen_Str source, int level);
+TZOZENDEF Json_Result parse_json_value_with_depth_and_options(Tzozen_Memory *memory, Tzozen_Str source, int level, const Json_Options *options);
+// A failed parse gives back the memory it used, unless the strings are
+// interned: the intern table may point to them already.
+TZOZENDEF Json_Result parse_json_value_with_options(Tzozen_Memory *memory, Tzozen_Str source, const Json_Options *options);
 TZOZENDEF Json_Result parse_json_value(Tzozen_Memory *memory, Tzozen_Str source);
+// Checks the document like parse_json_value_with_options() does and
+// computes the exact amount of memory the parse takes from an empty
+// memory aligned like the ones from malloc(), without allocating
+// anything. The `bytes_size` is what goes to Json_Options.bytes if it
+// is set and may be NULL otherwise. With Json_Options.intern it is an
+// upper bound, since the strings that are found in the table take
+// nothing.
+TZOZENDEF Json_Result json_measure(Tzozen_Str source, const Json_Options *options,
+                                   size_t *size, size_t *bytes_size);
+
+// Callbacks of parse_json_sax(). Any of them can be NULL. Returning a
+// negative number stops the parsing with an error. The strings and the
+// numbers are only valid during the call.
+typedef struct {
+    void *data;
+    int (*start_array)(void *data);
+    int (*end_array)(void *data);
+    int (*start_object)(void *data);
+    int (*end_object)(void *data);
+    int (*key)(void *data, Tzozen_Str key);
+    int (*string)(void *data, Tzozen_Str string);
+    int (*number)(void *data, Json_Number number);
+    int (*boolean)(void *data, int boolean);
+    int (*null)(void *data);
+} Json_Sax;
+
+// Reports the document as a sequence of events instead of building the
+// tree. Nothing is allocated except the strings with escape sequences,
+// which are decoded into `scratch` and freed right after their event.
+// Json_Options.borrow_source is implied. Json_Options.intern and the
+// container options don't apply. Only a byte per level of
+// Json_Options.stack is used.
+TZOZENDEF Json_Result parse_json_sax(Tzozen_Memory *scratch, Tzozen_Str source, const Json_Options *options, const Json_Sax *sax);
+
+// Skips the value at the beginning of the source (after the
+// whitespaces) by balancing the brackets and the quotes only. The
+// skipped value is not validated. The value of the result is the text
+// of the skipped value as a JSON_STRING.
+TZOZENDEF Json_Result json_skip_value(Tzozen_Str source);
+
+// Compares the contents of a string literal (as it is in the source,
+// without the quotes) with a decoded string without allocating.
+TZOZENDEF int json_literal_equal(Tzozen_Str literal, Tzozen_Str string);
+
+// On-demand cursor over the elements of an array or the members of an
+// object in the source. The elements are returned as the slices of the
+// source that they occupy. Nothing is parsed until the caller asks for
+// it with parse_json_value(), json_cursor_enter(), etc.
+typedef struct {
+    // The rest of the container after the last returned element. After
+    // the end of the container it is the rest after the closing bracket.
+    Tzozen_Str source;
+    char close;
+    size_t count;
+    int done;
+    // The error of the last call that returned -1. `source` points at it.
+    const char *message;
+} Json_Cursor;
+
+// Returns -1 if the value is not an array or an object
+TZOZENDEF int json_cursor_enter(Json_Cursor *cursor, Tzozen_Str value);
+// Returns 1 and the next element, 0 at the end of the container, -1 on
+// errors. `key` is the literal of the key without the quotes (empty for
+// the arrays). Both `key` and `value` can be NULL.
+TZOZENDEF int json_cursor_next(Json_Cursor *cursor, Tzozen_Str *key, Tzozen_Str *value);
+// Skips the members until `key` and returns 1 and its value, 0 if there
+// is no such key after the current position, -1 on errors. Looking up
+// the keys in the order they appear in the document is the fastest.
+TZOZENDEF int json_cursor_find(Json_Cursor *cursor, Tzozen_Str key, Tzozen_Str *value);
+
+// Path for parse_json_paths(). Either a JSON Pointer (`/user/id`,
+// `/events/*/ts`) or a dotted path (`user.id`, `events.*.ts`). The
+// empty path is the whole document. `*` matches every element of an
+// array or every member of an object.
+typedef struct {
+    Tzozen_Str path;
+
+    // Whether anything matched the path
+    int found;
+    // The matched value, or the array of all the matched values in the
+    // document order if the path has a `*` segment
+    Json_Value value;
+
+    // Internal state of parse_json_paths()
+    Tzozen_Str *segments;
+    size_t segments_count;
+    int wildcard;
+    size_t matched;
+} Json_Path;
+
+// Materializes only the values at the paths. Everything else is skipped
+// by json_skip_value() without building the tree and without being
+// validated. The path segments are split into `memory` too.
+TZOZENDEF Json_Result parse_json_paths(Tzozen_Memory *memory, Tzozen_Str source, Json_Path *paths, size_t paths_count, const Json_Options *options);
+
+// JSON Lines (NDJSON): one value per line.
+typedef struct {
+    // The line without the line break
+    Tzozen_Str line;
+    Json_Result result;
+} Json_Line;
+
+// Splits the source into at most `count` chunks of about the same size
+// at the line boundaries, so the chunks can be parsed independently (for
+// example on separate threads). Returns the amount of chunks.
+TZOZENDEF size_t json_lines_split(Tzozen_Str source, Tzozen_Str *chunks, size_t count);
+
+// Parses the lines of the source into `lines` until it is full or the
+// source is over. The blank lines are skipped. A line with anything but
+// whitespaces after the value is an error. Returns the amount of parsed
+// lines and moves `source` past them.
+TZOZENDEF size_t parse_json_lines(Tzozen_Memory *memory, Tzozen_Str *source, const Json_Options *options, Json_Line *lines, size_t capacity);
+
+// Splits the top level array at the beginning of the source into at
+// most `count` slices of about the same size for parsing them in
+// parallel with parse_json_elements(). The slices are the comma
+// separated elements without the brackets. The cuts are found with a
+// quote-aware scan of json_classify_block() blocks, the elements are
+// not validated. The rest of the result is after the closing bracket.
+TZOZENDEF Json_Result json_array_split(Tzozen_Str source, Tzozen_Str *slices, size_t count, size_t *slices_count);
+
+// Parses comma separated values that fill the whole source (a slice
+// from json_array_split()) into an array.
+TZOZENDEF Json_Result parse_json_elements(Tzozen_Memory *memory, Tzozen_Str source, const Json_Options *options);
+
+// Links the elements of `tail` to the end of `array`. The elements stay
+// in the memories they were allocated in.
+TZOZENDEF void json_array_concat(Json_Array *array, Json_Array tail);
+
+// Flat tape representation of a JSON document: one contiguous array of
+// 64-bit words. Every word holds a Json_Tape_Tag in the top 8 bits and
+// a payload in the low 56 bits:
+// - null/true/false: one word, no payload
+// - number: the length of the number literal, the next word is a
+//   pointer to it
+// - string: the length of the string, the next word is a pointer to it
+// - '[' and '{': the index of the word right after the matching
+//   ']'/'}', so the whole container can be skipped in O(1)
+// - ']' and '}': the index of the matching '['/'{'
+// Objects contain the key string followed by the value for every
+// member.
+typedef enum {
+    JSON_TAPE_NULL = 'n',
+    JSON_TAPE_TRUE = 't',
+    JSON_TAPE_FALSE = 'f',
+    JSON_TAPE_NUMBER = 'd',
+    JSON_TAPE_STRING = 's',
+    JSON_TAPE_ARRAY_BEGIN = '[',
+    JSON_TAPE_ARRAY_END = ']',
+    JSON_TAPE_OBJECT_BEGIN = '{',
+    JSON_TAPE_OBJECT_END = '}',
+} Json_Tape_Tag;
+
+#define JSON_TAPE_PAYLOAD_MASK ((((uint64_t) 1) << 56) - 1)
+
+typedef struct {
+    uint64_t *words;
+    size_t size;
+} Json_Tape;
+
+TZOZENDEF Json_Tape_Tag json_tape_tag(Json_Tape tape, size_t i);
+TZOZENDEF Json_Type json_tape_type(Json_Tape tape, size_t i);
+TZOZENDEF size_t json_tape_skip(Json_Tape tape, size_t i);
+TZOZENDEF size_t json_tape_next_elem(Json_Tape tape, size_t container, size_t elem);
+TZOZENDEF int json_tape_is_end(Json_Tape tape, size_t i);
+TZOZENDEF int json_tape_boolean(Json_Tape tape, size_t i);
+TZOZENDEF Tzozen_Str json_tape_string(Json_Tape tape, size_t i);
+TZOZENDEF Json_Number json_tape_number(Json_Tape tape, size_t i);
+TZOZENDEF size_t json_tape_object_value(Json_Tape tape, size_t key);
+
+// Iterates over the elements of the array or the keys of the object
+// that starts at the `container` word. Use json_tape_object_value() to
+// get to the value of the key.
+#define FOR_JSON_TAPE(tape, elem, container)                            \
+    for (size_t elem = (container) + 1;                                 \
+         !json_tape_is_end((tape), elem);                               \
+         elem = json_tape_next_elem((tape), (container), elem))
+
+// Words go to `tape_memory` and must be the only thing allocated there
+// during the parse so they stay contiguous. Strings and numbers go to
+// `memory` (or stay in the source with Json_Options.borrow_source).
+TZOZENDEF Json_Result parse_json_tape(Tzozen_Memory *memory, Tzozen_Memory *tape_memory, Tzozen_Str source, const Json_Options *options, Json_Tape *tape);
+
+// Compact 16-byte alternative to Json_Value. The elements of an array
+// and the members of an object are contiguous arrays of cells. Short
+// strings and the integers that fit into int64_t live right in the
+// cell, only the longer strings and the rest of the numbers take
+// memory outside of it.
+typedef enum {
+    JSON_CELL_NULL = 0,
+    JSON_CELL_FALSE,
+    JSON_CELL_TRUE,
+    JSON_CELL_INTEGER,
+    JSON_CELL_NUMBER,
+    JSON_CELL_SMALL_STRING,
+    JSON_CELL_STRING,
+    JSON_CELL_ARRAY,
+    JSON_CELL_OBJECT,
+} Json_Cell_Tag;
+
+// A small string takes the whole cell after the tag and its length
+#define JSON_CELL_SMALL_CAPACITY 14
+
+typedef struct Json_Cell Json_Cell;
+typedef struct Json_Cell_Member Json_Cell_Member;
+
+struct Json_Cell {
+    uint8_t tag;
+    uint8_t small_len;
+    uint16_t reserved;
+    // The length of a string or the amount of the elements or members
+    uint32_t size;
+    union {
+        int64_t integer;
+        const Json_Number *number;
+        const char *string;
+        const Json_Cell *elems;
+        const Json_Cell_Member *members;
+    } as;
+};
+
+struct Json_Cell_Member {
+    Json_Cell key;
+    Json_Cell value;
+};
+
+TZOZENDEF Json_Type json_cell_type(const Json_Cell *cell);
+TZOZENDEF int json_cell_boolean(const Json_Cell *cell);
+// The small strings point into the cell
+TZOZENDEF Tzozen_Str json_cell_string(const Json_Cell *cell);
+// Returns 1 if the number is a JSON_CELL_INTEGER. Use
+// json_cell_number() for the rest of them.
+TZOZENDEF int json_cell_integer(const Json_Cell *cell, int64_t *integer);
+TZOZENDEF Json_Number json_cell_number(const Json_Cell *cell);
+TZOZENDEF size_t json_cell_size(const Json_Cell *cell);
+TZOZENDEF const Json_Cell *json_cell_at(const Json_Cell *cell, size_t i);
+TZOZENDEF const Json_Cell_Member *json_cell_member(const Json_Cell *cell, size_t i);
+// The last member with the key, NULL if there is none
+TZOZENDEF const Json_Cell *json_cell_find(const Json_Cell *cell, Tzozen_Str key);
+
+// Converts the tree into cells allocated in `memory`. The strings and
+// numbers are copied unless they lie within `borrowed` (pass an empty
+// string to copy everything). `scratch` is only used during the call.
+TZOZENDEF int json_value_to_cell(Tzozen_Memory *memory, Tzozen_Memory *scratch,
+                                 Json_Value value, Tzozen_Str borrowed, Json_Cell *cell);
+
+// Parses the document straight into the cells in `memory`. `scratch`
+// only keeps the cells of the open containers and is rolled back
+// afterwards. With Json_Options.borrow_source the strings and numbers
+// keep pointing into the source. The frames of Json_Options.stack are
+// not used, only its capacity limits the depth. Json_Options.intern and
+// the container options don't apply.
+TZOZENDEF Json_Result parse_json_cells(Tzozen_Memory *memory, Tzozen_Memory *scratch, Tzozen_Str source, const Json_Options *options, Json_Cell *cell);
+
+typedef enum {
+    JSON_PUSH_NEED_MORE = 0,
+    JSON_PUSH_DONE,
+    JSON_PUSH_ERROR,
+} Json_Push_Status;
+
+typedef enum {
+    JSON_PUSH_VALUE = 0,
+    JSON_PUSH_ARRAY_FIRST,
+    JSON_PUSH_OBJECT_FIRST,
+    JSON_PUSH_KEY,
+    JSON_PUSH_COLON,
+    JSON_PUSH_AFTER_VALUE,
+    JSON_PUSH_STRING,
+    JSON_PUSH_NUMBER,
+    JSON_PUSH_LITERAL,
+    JSON_PUSH_END,
+} Json_Push_State;
+
+// Push parser that takes the document in chunks of any size. The
+// chunks are not needed after json_push_feed() returns: the strings and
+// the numbers that are split between the chunks are accumulated at the
+// end of the memory, so nothing else may be allocated in that memory
+// until the document is done.
+typedef struct {
+    Tzozen_Memory *memory;
+    // Where the document starts in the memory. An error rolls back to it.
+    Tzozen_Memory_Mark mark;
+    Json_Options options;
+    Json_Frame *stack;
+    size_t stack_capacity;
+    size_t depth;
+
+    Json_Push_State state;
+    Json_Push_Status status;
+    // Amount of bytes consumed so far. Points at the error if there is one.
+    size_t position;
+
+    // Where the raw string or number literal starts in the memory
+    size_t token_start;
+    int token_is_key;
+    int token_escape;
+    // The literal (true, false, null) that is being matched
+    Tzozen_Str literal;
+    size_t literal_matched;
+    Json_Value literal_value;
+    const char *literal_message;
+
+    Json_Value value;
+    const char *message;
+} Json_Push_Parser;
+
+// The options are copied. Json_Options.borrow_source doesn't apply.
+// Without Json_Options.stack JSON_DEPTH_MAX_LIMIT frames are allocated in the memory.
+TZOZENDEF int json_push_init(Json_Push_Parser *parser, Tzozen_Memory *memory, const Json_Options *options);
+TZOZENDEF Json_Push_Status json_push_feed(Json_Push_Parser *parser, Tzozen_Str chunk);
+// Tells the parser that there is no more input. Needed for the
+// documents that are just a number.
+TZOZENDEF Json_Push_Status json_push_finish(Json_Push_Parser *parser);
+
+// Destination of the json_write_*() serializer. The output is gathered
+// in `buffer` and handed to `flush` whenever it fills up. Without
+// `flush` the buffer is the whole output and writing past its capacity
+// sets `error`. Once `error` is set everything else is dropped.
+typedef struct {
+    char *buffer;
+    size_t capacity;
+    size_t size;
+    // Returns a negative number if the bytes could not be written
+    int (*flush)(void *data, const char *bytes, size_t size);
+    void *data;
+    int error;
+} Json_Sink;
+
+TZOZENDEF Json_Sink json_sink_buffer(char *buffer, size_t capacity);
+TZOZENDEF Json_Sink json_sink_flushing(char *buffer, size_t capacity,
+                                       int (*flush)(void *data, const char *bytes, size_t size),
+                                       void *data);
+// Hands the buffered output to `flush`. Returns -1 if anything was lost
+// since the sink was created.
+TZOZENDEF int json_sink_flush(Json_Sink *sink);
+TZOZENDEF void json_sink_write(Json_Sink *sink, const char *bytes, size_t size);
+TZOZENDEF void json_sink_putc(Json_Sink *sink, char c);
+
+TZOZENDEF void json_write_null(Json_Sink *sink);
+TZOZENDEF void json_write_boolean(Json_Sink *sink, int boolean);
+TZOZENDEF void json_write_integer(Json_Sink *sink, int64_t integer);
+TZOZENDEF void json_write_number(Json_Sink *sink, Json_Number number);
+TZOZENDEF void json_write_string(Json_Sink *sink, Tzozen_Str string);
+TZOZENDEF void json_write_array(Json_Sink *sink, Json_Array array);
+TZOZENDEF void json_write_object(Json_Sink *sink, Json_Object object);
+TZOZENDEF void json_write_value(Json_Sink *sink, Json_Value value);
+TZOZENDEF void json_write_cell(Json_Sink *sink, const Json_Cell *cell);
+
+// Streams the document from `source` into the `sink` without building
+// the tree, so the memory does not depend on the size of the document.
+// With `indent` 0 the output is minified, otherwise every element and
+// member goes on its own line indented by `indent` spaces per level.
+// Escapes in the strings and the exponents of the numbers are
+// normalized the same way the json_write_*() functions do it. Goes
+// through parse_json_sax(), so `scratch` and `options` mean the same.
+TZOZENDEF Json_Result json_reformat(Tzozen_Memory *scratch, Tzozen_Str source, const Json_Options *options,
+                                    size_t indent, Json_Sink *sink);
 
 #ifndef TZOZEN_NO_STDIO
+// Size of the stack buffer of the print_json_*() functions
+#ifndef TZOZEN_PRINT_BUFFER_CAPACITY
+#define TZOZEN_PRINT_BUFFER_CAPACITY 4096
+#endif
+
+// Sink that flushes into the `stream`. Call json_sink_flush() at the end.
+TZOZENDEF Json_Sink json_sink_file(FILE *stream, char *buffer, size_t capacity);
+
 TZOZENDEF void print_json_null(FILE *stream);
 TZOZENDEF void print_json_boolean(FILE *stream, int boolean);
 TZOZENDEF void print_json_number(FILE *stream, Json_Number number);
@@ -193,6 +756,7 @@ TZOZENDEF void print_json_string(FILE *stream, Tzozen_Str string);
 TZOZENDEF void print_json_array(FILE *stream, Json_Array array);
 TZOZENDEF void print_json_object(FILE *stream, Json_Object object);
 TZOZENDEF void print_json_value(FILE *stream, Json_Value value);
+TZOZENDEF void print_json_cell(FILE *stream, const Json_Cell *cell);
 TZOZENDEF void print_json_error(FILE *stream, Json_Result result, Tzozen_Str source, const char *prefix);
 #endif // TZOZEN_NO_STDIO
 
@@ -210,11 +774,139 @@ TZOZENDEF Tzozen_Memory tzozen_memory(uint8_t *buffer, size_t capacity)
     return memory;
 }
 
+struct Tzozen_Memory_Block {
+    Tzozen_Memory_Block *prev;
+    size_t allocated;
+    // The buffer of the memory before the block was chained
+    uint8_t *prev_buffer;
+    size_t prev_capacity;
+    size_t prev_size;
+};
+
+// Keeps the buffers of the chained blocks aligned for any value
+#define TZOZEN_MEMORY_BLOCK_HEADER ((sizeof(Tzozen_Memory_Block) + 15) / 16 * 16)
+
+TZOZENDEF Tzozen_Memory tzozen_memory_chained(uint8_t *buffer, size_t capacity,
+                                              const Tzozen_Allocator *allocator,
+                                              size_t block_size)
+{
+    assert(allocator);
+    Tzozen_Memory memory = tzozen_memory(buffer, capacity);
+    memory.allocator = allocator;
+    memory.block_size = block_size;
+    return memory;
+}
+
+// Continues the memory in a new block with at least `size` free bytes
+static int memory_chain(Tzozen_Memory *memory, size_t size)
+{
+    if (memory->allocator == NULL) {
+        return -1;
+    }
+
+    size_t capacity = size > memory->block_size ? size : memory->block_size;
+    if (capacity > SIZE_MAX - TZOZEN_MEMORY_BLOCK_HEADER) {
+        return -1;
+    }
+
+    size_t allocated = TZOZEN_MEMORY_BLOCK_HEADER + capacity;
+    Tzozen_Memory_Block *block = memory->spare;
+    if (block != NULL && block->allocated >= allocated) {
+        memory->spare = NULL;
+        allocated = block->allocated;
+        capacity = allocated - TZOZEN_MEMORY_BLOCK_HEADER;
+    } else {
+        block = (Tzozen_Memory_Block *) memory->allocator->alloc(memory->allocator->data, allocated);
+        if (block == NULL) {
+            return -1;
+        }
+    }
+
+    block->prev = memory->block;
+    block->allocated = allocated;
+    block->prev_buffer = memory->buffer;
+    block->prev_capacity = memory->capacity;
+    block->prev_size = memory->size;
+
+    memory->block = block;
+    memory->buffer = (uint8_t *) block + TZOZEN_MEMORY_BLOCK_HEADER;
+    memory->capacity = capacity;
+    memory->size = 0;
+
+    return 0;
+}
+
+// Gives back everything allocated since the memory was at the `size`
+// of the `buffer`
+static void memory_restore(Tzozen_Memory *memory, uint8_t *buffer, size_t size)
+{
+    while (memory->buffer != buffer) {
+        Tzozen_Memory_Block *block = memory->block;
+        assert(block);
+
+        memory->block = block->prev;
+        memory->buffer = block->prev_buffer;
+        memory->capacity = block->prev_capacity;
+        memory->size = block->prev_size;
+
+        // Only the biggest block is kept
+        if (memory->spare != NULL && memory->spare->allocated > block->allocated) {
+            Tzozen_Memory_Block *swap = memory->spare;
+            memory->spare = block;
+            block = swap;
+        }
+        if (memory->spare != NULL && memory->allocator->free) {
+            memory->allocator->free(memory->allocator->data, memory->spare, memory->spare->allocated);
+        }
+        memory->spare = block;
+    }
+
+    assert(size <= memory->capacity);
+    memory->size = size;
+}
+
+TZOZENDEF Tzozen_Memory_Mark tzozen_memory_save(const Tzozen_Memory *memory)
+{
+    assert(memory);
+    Tzozen_Memory_Mark mark;
+    mark.buffer = memory->buffer;
+    mark.size = memory->size;
+    return mark;
+}
+
+TZOZENDEF void tzozen_memory_rollback(Tzozen_Memory *memory, Tzozen_Memory_Mark mark)
+{
+    assert(memory);
+    memory_restore(memory, mark.buffer, mark.size);
+}
+
+TZOZENDEF void tzozen_memory_reset(Tzozen_Memory *memory)
+{
+    assert(memory);
+
+    while (memory->block != NULL) {
+        memory_restore(memory, memory->block->prev_buffer, 0);
+    }
+    memory->size = 0;
+}
+
+TZOZENDEF void tzozen_memory_free(Tzozen_Memory *memory)
+{
+    assert(memory);
+
+    tzozen_memory_reset(memory);
+    if (memory->spare != NULL && memory->allocator->free) {
+        memory->allocator->free(memory->allocator->data, memory->spare, memory->spare->allocated);
+    }
+    memory->spare = NULL;
+}
+
 TZOZENDEF void *memory_alloc(Tzozen_Memory *memory, size_t size)
 {
     assert(memory);
     
-    if (memory->size + size > memory->capacity) {
+    if ((memory->buffer == NULL || size > memory->capacity - memory->size)
+        && memory_chain(memory, size) < 0) {
         return NULL;
     }
 
@@ -224,6 +916,60 @@ TZOZENDEF void *memory_alloc(Tzozen_Memory *memory, size_t size)
     return result;
 }
 
+TZOZENDEF void *memory_alloc_aligned(Tzozen_Memory *memory, size_t size, size_t alignment)
+{
+    assert(memory);
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    size_t padding = 0;
+    if (memory->buffer != NULL) {
+        padding = (alignment - (uintptr_t) (memory->buffer + memory->size) % alignment) % alignment;
+    }
+
+    if (memory->buffer == NULL
+        || padding > memory->capacity - memory->size
+        || size > memory->capacity - memory->size - padding) {
+        if (size > SIZE_MAX - alignment || memory_chain(memory, size + alignment - 1) < 0) {
+            return NULL;
+        }
+        padding = (alignment - (uintptr_t) (memory->buffer + memory->size) % alignment) % alignment;
+    }
+
+    void *result = memory->buffer + memory->size + padding;
+    memory->size += padding + size;
+
+    return result;
+}
+
+TZOZENDEF void *memory_extend(Tzozen_Memory *memory, void *begin, size_t size)
+{
+    assert(memory);
+
+    uint8_t *run = (uint8_t *) begin;
+    assert(memory->buffer <= run && run <= memory->buffer + memory->size);
+    size_t run_size = (size_t) (memory->buffer + memory->size - run);
+
+    if (memory->buffer != NULL && size <= memory->capacity - memory->size) {
+        memory->size += size;
+        return run;
+    }
+
+    if (run_size + size < run_size) {
+        return NULL;
+    }
+
+    // Doubling keeps the moves of a long run linear
+    if (memory_chain(memory, 2 * (run_size + size)) < 0) {
+        return NULL;
+    }
+
+    memcpy(memory->buffer, run, run_size);
+    memory->size = run_size + size;
+    memory->block->prev_size -= run_size;
+
+    return memory->buffer;
+}
+
 TZOZENDEF Tzozen_Str tzozen_str(size_t len, const char *data)
 {
     Tzozen_Str result = {len, data};
@@ -310,16 +1056,102 @@ TZOZENDEF const char *json_type_as_cstr(Json_Type type)
 
 TZOZENDEF size_t json_array_size(Json_Array array)
 {
-    size_t size = 0;
-    FOR_JSON (Json_Array, elem, array) size += 1;
-    return size;
+    return array.size;
 }
 
 TZOZENDEF size_t json_object_size(Json_Object object)
 {
-    size_t size = 0;
-    FOR_JSON (Json_Object, elem, object) size += 1;
-    return size;
+    return object.size;
+}
+
+TZOZENDEF int json_array_finalize(Tzozen_Memory *memory, Json_Array *array)
+{
+    if (array->elems != NULL || array->size == 0) {
+        return 0;
+    }
+
+    Json_Array_Elem **elems = TZOZEN_ALLOC(memory, Json_Array_Elem*, array->size);
+    if (elems == NULL) {
+        return -1;
+    }
+
+    size_t i = 0;
+    FOR_JSON (Json_Array, elem, *array) elems[i++] = elem;
+    assert(i == array->size);
+
+    array->elems = elems;
+    return 0;
+}
+
+TZOZENDEF int json_object_finalize(Tzozen_Memory *memory, Json_Object *object)
+{
+    if (object->elems != NULL || object->size == 0) {
+        return 0;
+    }
+
+    Json_Object_Elem **elems = TZOZEN_ALLOC(memory, Json_Object_Elem*, object->size);
+    if (elems == NULL) {
+        return -1;
+    }
+
+    size_t i = 0;
+    FOR_JSON (Json_Object, elem, *object) elems[i++] = elem;
+    assert(i == object->size);
+
+    object->elems = elems;
+    return 0;
+}
+
+// O(1) if the array is finalized, O(i) otherwise
+TZOZENDEF Json_Value json_array_at(Json_Array array, size_t i)
+{
+    assert(i < array.size);
+
+    if (array.elems != NULL) {
+        return array.elems[i]->value;
+    }
+
+    Json_Array_Elem *elem = array.begin;
+    while (i-- > 0) elem = elem->next;
+    return elem->value;
+}
+
+// O(1) if the object is finalized, O(i) otherwise
+TZOZENDEF Json_Object_Elem *json_object_at(Json_Object object, size_t i)
+{
+    assert(i < object.size);
+
+    if (object.elems != NULL) {
+        return object.elems[i];
+    }
+
+    Json_Object_Elem *elem = object.begin;
+    while (i-- > 0) elem = elem->next;
+    return elem;
+}
+
+TZOZENDEF int json_value_finalize(Tzozen_Memory *memory, Json_Value *value)
+{
+    switch (value->type) {
+    case JSON_NULL:
+    case JSON_BOOLEAN:
+    case JSON_NUMBER:
+    case JSON_STRING:
+        return 0;
+    case JSON_ARRAY:
+        FOR_JSON (Json_Array, elem, value->array) {
+            if (json_value_finalize(memory, &elem->value) < 0) return -1;
+        }
+        return json_array_finalize(memory, &value->array);
+    case JSON_OBJECT:
+        FOR_JSON (Json_Object, elem, value->object) {
+            if (json_value_finalize(memory, &elem->value) < 0) return -1;
+        }
+        return json_object_finalize(memory, &value->object);
+    }
+
+    assert(0 && "Incorrect Json_Type");
+    return -1;
 }
 
 
@@ -417,7 +1249,7 @@ TZOZENDEF Tzozen_Str tzozen_str_trim_begin(Tzozen_Str s)
 
 TZOZENDEF int json_array_push(Tzozen_Memory *memory, Json_Array *array, Json_Value value)
 {
-    Json_Array_Elem *next = (Json_Array_Elem *) memory_alloc(memory, sizeof(Json_Array_Elem));
+    Json_Array_Elem *next = TZOZEN_ALLOC(memory, Json_Array_Elem, 1);
     if (next == NULL) {
         return -1;
     }
@@ -434,13 +1266,16 @@ TZOZENDEF int json_array_push(Tzozen_Memory *memory, Json_Array *array, Json_Val
     }
 
     array->end = next;
+    array->size += 1;
+    // The vector can't grow in place
+    array->elems = NULL;
 
     return 0;
 }
 
 TZOZENDEF int json_object_push(Tzozen_Memory *memory, Json_Object *object, Tzozen_Str key, Json_Value value)
 {
-    Json_Object_Elem *next = (Json_Object_Elem *) memory_alloc(memory, sizeof(Json_Object_Elem));
+    Json_Object_Elem *next = TZOZEN_ALLOC(memory, Json_Object_Elem, 1);
     if (next == NULL) {
         return -1;
     }
@@ -457,84 +1292,1595 @@ TZOZENDEF int json_object_push(Tzozen_Memory *memory, Json_Object *object, Tzoze
     }
 
     object->end = next;
+    object->size += 1;
+    object->elems = NULL;
+    object->table = NULL;
     return 0;
 }
 
-TZOZENDEF int64_t tzozen_str_stoi64(Tzozen_Str integer)
+static const uint64_t json_powers_of_ten_u64[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+#ifdef TZOZEN_LITTLE_ENDIAN
+// SWAR: converts 8 ASCII digits to their value in 3 multiplications.
+// See http://govnokod.ru/13461 and https://lemire.me/blog/2022/01/21/swar-explained-parsing-eight-digits/
+static uint64_t json_parse_eight_digits(const char *chars)
 {
-    if (integer.len == 0) {
-        return 0;
+    uint64_t val;
+    memcpy(&val, chars, sizeof(val));
+    assert((((val & 0xF0F0F0F0F0F0F0F0ULL)
+             | (((val + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+            == 0x3333333333333333ULL) && "Expected 8 digits");
+    val = (val & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+    val = (val & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+    return (val & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32;
+}
+#endif
+
+// Parses a run of decimal digits. Returns -1 if the value does not fit
+// into uint64_t.
+static int json_digits_to_u64(Tzozen_Str digits, uint64_t *result)
+{
+    while (digits.len && *digits.data == '0') {
+        tzozen_str_chop(&digits, 1);
     }
 
-    int64_t result = 0;
-    int64_t sign = 1;
+    // 19 digits always fit, 20 digits may fit, 21 digits never fit
+    if (digits.len > 20) {
+        return -1;
+    }
 
-    if (*integer.data == '-') {
-        sign = -1;
-        tzozen_str_chop(&integer, 1);
-    } else if (*integer.data == '+') {
-        sign = 1;
-        tzozen_str_chop(&integer, 1);
+    size_t safe_len = digits.len < 19 ? digits.len : 19;
+    uint64_t value = 0;
+    size_t i = 0;
+
+#ifdef TZOZEN_LITTLE_ENDIAN
+    for (; i + 8 <= safe_len; i += 8) {
+        value = value * 100000000 + json_parse_eight_digits(digits.data + i);
     }
+#endif
 
-    while (integer.len) {
-        assert(json_isdigit(*integer.data));
-        result = result * 10 + (*integer.data - '0');
-        tzozen_str_chop(&integer, 1);
+    for (; i < safe_len; ++i) {
+        assert(json_isdigit(digits.data[i]));
+        value = value * 10 + (uint64_t) (digits.data[i] - '0');
+    }
+
+    if (i < digits.len) {
+        assert(json_isdigit(digits.data[i]));
+        uint64_t digit = (uint64_t) (digits.data[i] - '0');
+        if (value > (UINT64_MAX - digit) / 10) {
+            return -1;
+        }
+        value = value * 10 + digit;
     }
 
-    return result * sign;
+    *result = value;
+    return 0;
 }
 
-TZOZENDEF int64_t json_number_to_integer(Json_Number number)
+static int json_i64_from_magnitude(uint64_t magnitude, int negative, int64_t *result)
 {
-    int64_t exponent = tzozen_str_stoi64(number.exponent);
-    int64_t result = tzozen_str_stoi64(number.integer);
-
-    if (exponent > 0) {
-        int64_t sign = result >= 0 ? 1 : -1;
-
-        for (; exponent > 0; exponent -= 1) {
-            int64_t x = 0;
-
-            if (number.fraction.len) {
-                x = *number.fraction.data - '0';
-                tzozen_str_chop(&number.fraction, 1);
-            }
+    if (negative) {
+        if (magnitude > (uint64_t) INT64_MAX + 1) return -1;
+        *result = magnitude == (uint64_t) INT64_MAX + 1
+            ? INT64_MIN
+            : -(int64_t) magnitude;
+    } else {
+        if (magnitude > (uint64_t) INT64_MAX) return -1;
+        *result = (int64_t) magnitude;
+    }
+    return 0;
+}
 
-            result = result * 10 + sign * x;
-        }
+// Returns -1 if the integer does not fit into int64_t
+TZOZENDEF int tzozen_str_stoi64_checked(Tzozen_Str integer, int64_t *result)
+{
+    int negative = 0;
+    if (integer.len && (*integer.data == '-' || *integer.data == '+')) {
+        negative = *integer.data == '-';
+        tzozen_str_chop(&integer, 1);
     }
 
-    for (; exponent < 0 && result; exponent += 1) {
-        result /= 10;
+    uint64_t magnitude = 0;
+    if (json_digits_to_u64(integer, &magnitude) < 0) {
+        return -1;
     }
 
-    return result;
+    return json_i64_from_magnitude(magnitude, negative, result);
 }
 
-TZOZENDEF Json_Result result_success(Tzozen_Str rest, Json_Value value)
+// Saturates to INT64_MIN/INT64_MAX on overflow. Use
+// tzozen_str_stoi64_checked() to find out about it.
+TZOZENDEF int64_t tzozen_str_stoi64(Tzozen_Str integer)
 {
-    Json_Result result;
-    memset(&result, 0, sizeof(result));
-    result.value = value;
-    result.rest = rest;
+    int64_t result = 0;
+    if (tzozen_str_stoi64_checked(integer, &result) < 0) {
+        return integer.len && *integer.data == '-' ? INT64_MIN : INT64_MAX;
+    }
     return result;
 }
 
-TZOZENDEF Json_Result result_failure(Tzozen_Str rest, const char *message)
+// Powers of five 5^q for q in [JSON_POWER_OF_FIVE_MIN, 308] normalized
+// to 128 bits (the high word goes first). Used by the Eisel-Lemire
+// algorithm in json_number_to_double().
+#define JSON_POWER_OF_FIVE_MIN (-342)
+#define JSON_POWER_OF_FIVE_MAX 308
+static const uint64_t json_power_of_five_128[] = {
+    0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL,
+    0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+    0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL,
+    0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+    0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL,
+    0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+    0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL,
+    0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+    0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL,
+    0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+    0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL,
+    0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+    0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL,
+    0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+    0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL,
+    0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+    0x84a57695fe98746dULL, 0x014bb630f7604b57ULL,
+    0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+    0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL,
+    0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+    0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL,
+    0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+    0xfd00b897478238d0ULL, 0x8920b098955522b4ULL,
+    0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+    0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL,
+    0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+    0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL,
+    0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+    0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL,
+    0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+    0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL,
+    0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+    0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL,
+    0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+    0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL,
+    0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+    0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL,
+    0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+    0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL,
+    0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+    0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL,
+    0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+    0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL,
+    0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+    0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL,
+    0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+    0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL,
+    0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+    0xa37fce126597973cULL, 0xe50ff107bab528a0ULL,
+    0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+    0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL,
+    0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+    0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL,
+    0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+    0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL,
+    0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+    0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL,
+    0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+    0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL,
+    0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+    0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL,
+    0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+    0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL,
+    0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+    0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL,
+    0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+    0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL,
+    0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+    0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL,
+    0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+    0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL,
+    0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+    0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL,
+    0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+    0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL,
+    0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+    0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL,
+    0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+    0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL,
+    0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+    0xc987434744ac874eULL, 0xa327ffb266b56220ULL,
+    0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+    0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL,
+    0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+    0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL,
+    0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+    0xc0314325637a1939ULL, 0xfa911155fefb5308ULL,
+    0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+    0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL,
+    0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+    0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL,
+    0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+    0xb749faed14125d36ULL, 0xcef980ec671f667bULL,
+    0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+    0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL,
+    0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+    0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL,
+    0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+    0xaecc49914078536dULL, 0x58fae9f773886e18ULL,
+    0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+    0x888f99797a5e012dULL, 0x6d8406c952429603ULL,
+    0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+    0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL,
+    0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+    0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL,
+    0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+    0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL,
+    0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+    0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL,
+    0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+    0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL,
+    0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+    0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL,
+    0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+    0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL,
+    0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+    0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL,
+    0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+    0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL,
+    0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+    0xb913179899f68584ULL, 0x28e2557b59846e3fULL,
+    0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+    0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL,
+    0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+    0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL,
+    0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+    0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL,
+    0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+    0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL,
+    0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+    0xd77485cb25823ac7ULL, 0x7d633293366b828bULL,
+    0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+    0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL,
+    0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+    0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL,
+    0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+    0xcd795be870516656ULL, 0x67902e276c921f8bULL,
+    0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+    0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL,
+    0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+    0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL,
+    0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+    0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL,
+    0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+    0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL,
+    0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+    0xef340a98172aace4ULL, 0x86fb897116c87c34ULL,
+    0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+    0xbae0a846d2195712ULL, 0x8974836059cca109ULL,
+    0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+    0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL,
+    0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+    0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL,
+    0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+    0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL,
+    0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+    0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL,
+    0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+    0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL,
+    0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+    0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL,
+    0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+    0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL,
+    0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+    0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL,
+    0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+    0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL,
+    0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+    0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL,
+    0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+    0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL,
+    0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+    0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL,
+    0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+    0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL,
+    0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+    0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL,
+    0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+    0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL,
+    0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+    0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL,
+    0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+    0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL,
+    0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+    0x8c974f7383725573ULL, 0x1e414218c73a13fbULL,
+    0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+    0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL,
+    0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+    0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL,
+    0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+    0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL,
+    0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+    0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL,
+    0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+    0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL,
+    0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+    0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL,
+    0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+    0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL,
+    0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+    0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL,
+    0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+    0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL,
+    0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+    0xbe89523386091465ULL, 0xf6bbb397f1135823ULL,
+    0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+    0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL,
+    0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+    0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL,
+    0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+    0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL,
+    0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+    0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL,
+    0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+    0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL,
+    0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+    0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL,
+    0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+    0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL,
+    0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+    0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL,
+    0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+    0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL,
+    0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+    0x811ccc668829b887ULL, 0x0806357d5a3f525fULL,
+    0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+    0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL,
+    0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+    0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL,
+    0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+    0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL,
+    0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+    0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL,
+    0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+    0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL,
+    0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+    0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL,
+    0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+    0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL,
+    0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+    0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL,
+    0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+    0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL,
+    0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+    0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL,
+    0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+    0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL,
+    0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+    0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL,
+    0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+    0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL,
+    0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+    0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL,
+    0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+    0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL,
+    0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+    0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL,
+    0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+    0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL,
+    0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+    0xc24452da229b021bULL, 0xfbe85badce996168ULL,
+    0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+    0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL,
+    0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+    0xed246723473e3813ULL, 0x290123e9aab23b68ULL,
+    0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+    0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL,
+    0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+    0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL,
+    0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+    0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL,
+    0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+    0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL,
+    0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+    0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL,
+    0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+    0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL,
+    0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL,
+    0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL,
+    0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL,
+    0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL,
+    0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL,
+    0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL,
+    0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL,
+    0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL,
+    0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL,
+    0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL,
+    0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL,
+    0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL,
+    0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL,
+    0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL,
+    0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL,
+    0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL,
+    0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL,
+    0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL,
+    0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL,
+    0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+    0xc612062576589ddaULL, 0x95364afe032a819eULL,
+    0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL,
+    0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL,
+    0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL,
+    0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL,
+    0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL,
+    0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL,
+    0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL,
+    0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL,
+    0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL,
+    0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL,
+    0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL,
+    0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL,
+    0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL,
+    0xa000000000000000ULL, 0x0000000000000000ULL,
+    0xc800000000000000ULL, 0x0000000000000000ULL,
+    0xfa00000000000000ULL, 0x0000000000000000ULL,
+    0x9c40000000000000ULL, 0x0000000000000000ULL,
+    0xc350000000000000ULL, 0x0000000000000000ULL,
+    0xf424000000000000ULL, 0x0000000000000000ULL,
+    0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xbebc200000000000ULL, 0x0000000000000000ULL,
+    0xee6b280000000000ULL, 0x0000000000000000ULL,
+    0x9502f90000000000ULL, 0x0000000000000000ULL,
+    0xba43b74000000000ULL, 0x0000000000000000ULL,
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL,
+    0x9184e72a00000000ULL, 0x0000000000000000ULL,
+    0xb5e620f480000000ULL, 0x0000000000000000ULL,
+    0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL,
+    0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL,
+    0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL,
+    0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+    0x878678326eac9000ULL, 0x0000000000000000ULL,
+    0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL,
+    0x84595161401484a0ULL, 0x0000000000000000ULL,
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL,
+    0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+    0x813f3978f8940984ULL, 0x4000000000000000ULL,
+    0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL,
+    0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL,
+    0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL,
+    0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL,
+    0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL,
+    0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+    0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL,
+    0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+    0xb7abc627050305adULL, 0xf14a3d9e40000000ULL,
+    0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+    0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL,
+    0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+    0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL,
+    0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+    0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL,
+    0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+    0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL,
+    0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+    0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL,
+    0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+    0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL,
+    0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+    0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL,
+    0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+    0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL,
+    0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+    0x9f4f2726179a2245ULL, 0x01d762422c946590ULL,
+    0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+    0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL,
+    0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+    0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL,
+    0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+    0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL,
+    0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+    0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL,
+    0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+    0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL,
+    0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+    0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL,
+    0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+    0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL,
+    0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+    0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL,
+    0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+    0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL,
+    0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+    0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL,
+    0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+    0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL,
+    0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+    0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL,
+    0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+    0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL,
+    0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+    0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL,
+    0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+    0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL,
+    0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+    0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL,
+    0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+    0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL,
+    0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+    0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL,
+    0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+    0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL,
+    0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+    0x924d692ca61be758ULL, 0x593c2626705f9c56ULL,
+    0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+    0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL,
+    0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+    0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL,
+    0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+    0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL,
+    0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+    0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL,
+    0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+    0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL,
+    0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+    0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL,
+    0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+    0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL,
+    0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+    0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL,
+    0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+    0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL,
+    0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+    0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL,
+    0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+    0x9ae757596946075fULL, 0x3375788de9b06958ULL,
+    0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+    0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL,
+    0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+    0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL,
+    0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+    0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL,
+    0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+    0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL,
+    0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+    0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL,
+    0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+    0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL,
+    0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+    0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL,
+    0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+    0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL,
+    0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+    0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL,
+    0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+    0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL,
+    0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+    0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL,
+    0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+    0x802221226be55a64ULL, 0xc2494954da2c9789ULL,
+    0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+    0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL,
+    0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+    0x9c69a97284b578d7ULL, 0xff2a760414536efbULL,
+    0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+    0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL,
+    0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+    0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL,
+    0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+    0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL,
+    0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+    0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL,
+    0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+    0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL,
+    0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+    0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL,
+    0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+    0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL,
+    0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+    0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL,
+    0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+    0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL,
+    0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+    0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL,
+    0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+    0xa59bc234db398c25ULL, 0x43fab9837e699095ULL,
+    0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+    0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL,
+    0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+    0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL,
+    0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+    0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL,
+    0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+    0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL,
+    0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+    0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL,
+    0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+    0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL,
+    0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+    0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL,
+    0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+    0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL,
+    0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+    0x8fa475791a569d10ULL, 0xf96e017d694487bcULL,
+    0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+    0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL,
+    0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+    0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL,
+    0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+    0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL,
+    0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+    0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL,
+    0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+    0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL,
+    0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+    0x82a45b450226b39cULL, 0xecc0024661173473ULL,
+    0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+    0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL,
+    0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+    0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL,
+    0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+    0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL,
+    0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+    0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL,
+    0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+    0x98165af37b2153deULL, 0xc3727a337a8b704aULL,
+    0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+    0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL,
+    0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+    0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL,
+    0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+    0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL,
+    0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+    0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL,
+    0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+    0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL,
+    0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+    0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL,
+    0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+    0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL,
+    0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+    0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL,
+    0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+    0x83ea2b892091e44dULL, 0x934aed0aab460432ULL,
+    0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+    0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL,
+    0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+    0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL,
+    0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+    0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL,
+    0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+    0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL,
+    0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+    0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL,
+    0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+    0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL,
+    0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+    0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL,
+    0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+    0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL,
+    0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+    0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL,
+    0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+    0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL,
+    0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+    0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL,
+    0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+    0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL,
+    0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+    0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL,
+    0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+    0x8533285c936b35deULL, 0xd53a88958f87275fULL,
+    0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+    0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL,
+    0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+    0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL,
+    0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+    0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL,
+    0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+    0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL,
+    0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+    0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL,
+    0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+    0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL,
+    0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+    0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL,
+    0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+    0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL,
+    0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+    0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL,
+    0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+    0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL,
+    0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+    0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL,
+    0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+    0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL,
+    0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+    0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL,
+    0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+    0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL,
+    0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+    0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL,
+    0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+    0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL,
+    0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+    0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL,
+    0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+    0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL,
+    0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+    0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL,
+    0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+    0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL,
+    0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+    0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL,
+    0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+    0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL,
+    0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+    0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL,
+    0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+    0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL,
+    0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+    0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL,
+};
+
+static int json_clz64(uint64_t x)
 {
-    Json_Result result;
-    memset(&result, 0, sizeof(result));
-    result.is_error = 1;
-    result.rest = rest;
-    result.message = message;
-    return result;
+    assert(x != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while ((x & ((uint64_t) 1 << 63)) == 0) {
+        x <<= 1;
+        n += 1;
+    }
+    return n;
+#endif
 }
 
-TZOZENDEF Json_Result parse_token(Tzozen_Str source, Tzozen_Str token,
-                        Json_Value value,
-                        const char *message)
+static uint64_t json_mul_u64(uint64_t a, uint64_t b, uint64_t *lo)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 Json_U128;
+    Json_U128 p = (Json_U128) a * b;
+    *lo = (uint64_t) p;
+    return (uint64_t) (p >> 64);
+#else
+    uint64_t a_lo = (uint32_t) a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t) b, b_hi = b >> 32;
+    uint64_t ll = a_lo * b_lo;
+    uint64_t lh = a_lo * b_hi;
+    uint64_t hl = a_hi * b_lo;
+    uint64_t hh = a_hi * b_hi;
+    uint64_t mid = (ll >> 32) + (uint32_t) lh + (uint32_t) hl;
+    *lo = (mid << 32) | (uint32_t) ll;
+    return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+#define JSON_DOUBLE_MANTISSA_BITS 52
+#define JSON_DOUBLE_EXPONENT_BIAS 1023
+#define JSON_DOUBLE_INFINITE_POWER 0x7FF
+
+// Eisel-Lemire: the binary mantissa and exponent of w * 10^q rounded to
+// the nearest double. w must be non-zero and q within the table. See
+// https://arxiv.org/abs/2101.11408 and https://github.com/fastfloat/fast_float
+static void json_eisel_lemire(uint64_t w, int64_t q, uint64_t *mantissa, int64_t *power2)
+{
+    assert(w != 0);
+    assert(JSON_POWER_OF_FIVE_MIN <= q && q <= JSON_POWER_OF_FIVE_MAX);
+
+    int lz = json_clz64(w);
+    w <<= lz;
+
+    size_t index = 2 * (size_t) (q - JSON_POWER_OF_FIVE_MIN);
+    uint64_t lo;
+    uint64_t hi = json_mul_u64(w, json_power_of_five_128[index], &lo);
+
+    // The truncated product is only insufficient when all the bits
+    // below the mantissa are ones. Then the second half of the power
+    // settles it.
+    const uint64_t precision_mask = UINT64_MAX >> (JSON_DOUBLE_MANTISSA_BITS + 3);
+    if ((hi & precision_mask) == precision_mask) {
+        uint64_t second_lo;
+        uint64_t second_hi = json_mul_u64(w, json_power_of_five_128[index + 1], &second_lo);
+        lo += second_hi;
+        if (second_hi > lo) hi += 1;
+    }
+
+    int upperbit = (int) (hi >> 63);
+    int shift = upperbit + 64 - JSON_DOUBLE_MANTISSA_BITS - 3;
+    uint64_t m = hi >> shift;
+    int64_t p = (((152170 + 65536) * q) >> 16) + 63 + upperbit - lz + JSON_DOUBLE_EXPONENT_BIAS;
+
+    if (p <= 0) {
+        // Subnormal
+        if (-p + 1 >= 64) {
+            *mantissa = 0;
+            *power2 = 0;
+            return;
+        }
+        m >>= -p + 1;
+        m += m & 1;
+        m >>= 1;
+        *mantissa = m;
+        *power2 = m < ((uint64_t) 1 << JSON_DOUBLE_MANTISSA_BITS) ? 0 : 1;
+        return;
+    }
+
+    // Exactly halfway between two doubles: round to even
+    if (lo <= 1 && q >= -4 && q <= 23 && (m & 3) == 1 && (m << shift) == hi) {
+        m &= ~(uint64_t) 1;
+    }
+
+    m += m & 1;
+    m >>= 1;
+    if (m >= ((uint64_t) 2 << JSON_DOUBLE_MANTISSA_BITS)) {
+        m = (uint64_t) 1 << JSON_DOUBLE_MANTISSA_BITS;
+        p += 1;
+    }
+    m &= ~((uint64_t) 1 << JSON_DOUBLE_MANTISSA_BITS);
+
+    if (p >= JSON_DOUBLE_INFINITE_POWER) {
+        m = 0;
+        p = JSON_DOUBLE_INFINITE_POWER;
+    }
+
+    *mantissa = m;
+    *power2 = p;
+}
+
+// Arbitrary precision decimal for the rare cases Eisel-Lemire can't
+// decide. This is the "simple decimal conversion" from Go's strconv.
+#define JSON_DECIMAL_CAPACITY 800
+
+typedef struct {
+    uint8_t digits[JSON_DECIMAL_CAPACITY];
+    int count;
+    int point;
+    int truncated;
+} Json_Decimal;
+
+#define JSON_DECIMAL_MAX_SHIFT 60
+
+static const struct {
+    int delta;
+    const char *cutoff;
+} json_decimal_left_cheats[JSON_DECIMAL_MAX_SHIFT + 1] = {
+    {0, ""},
+    {1, "5"},
+    {1, "25"},
+    {1, "125"},
+    {2, "625"},
+    {2, "3125"},
+    {2, "15625"},
+    {3, "78125"},
+    {3, "390625"},
+    {3, "1953125"},
+    {4, "9765625"},
+    {4, "48828125"},
+    {4, "244140625"},
+    {4, "1220703125"},
+    {5, "6103515625"},
+    {5, "30517578125"},
+    {5, "152587890625"},
+    {6, "762939453125"},
+    {6, "3814697265625"},
+    {6, "19073486328125"},
+    {7, "95367431640625"},
+    {7, "476837158203125"},
+    {7, "2384185791015625"},
+    {7, "11920928955078125"},
+    {8, "59604644775390625"},
+    {8, "298023223876953125"},
+    {8, "1490116119384765625"},
+    {9, "7450580596923828125"},
+    {9, "37252902984619140625"},
+    {9, "186264514923095703125"},
+    {10, "931322574615478515625"},
+    {10, "4656612873077392578125"},
+    {10, "23283064365386962890625"},
+    {10, "116415321826934814453125"},
+    {11, "582076609134674072265625"},
+    {11, "2910383045673370361328125"},
+    {11, "14551915228366851806640625"},
+    {12, "72759576141834259033203125"},
+    {12, "363797880709171295166015625"},
+    {12, "1818989403545856475830078125"},
+    {13, "9094947017729282379150390625"},
+    {13, "45474735088646411895751953125"},
+    {13, "227373675443232059478759765625"},
+    {13, "1136868377216160297393798828125"},
+    {14, "5684341886080801486968994140625"},
+    {14, "28421709430404007434844970703125"},
+    {14, "142108547152020037174224853515625"},
+    {15, "710542735760100185871124267578125"},
+    {15, "3552713678800500929355621337890625"},
+    {15, "17763568394002504646778106689453125"},
+    {16, "88817841970012523233890533447265625"},
+    {16, "444089209850062616169452667236328125"},
+    {16, "2220446049250313080847263336181640625"},
+    {16, "11102230246251565404236316680908203125"},
+    {17, "55511151231257827021181583404541015625"},
+    {17, "277555756156289135105907917022705078125"},
+    {17, "1387778780781445675529539585113525390625"},
+    {18, "6938893903907228377647697925567626953125"},
+    {18, "34694469519536141888238489627838134765625"},
+    {18, "173472347597680709441192448139190673828125"},
+    {19, "867361737988403547205962240695953369140625"},
+};
+
+static void json_decimal_trim(Json_Decimal *d)
+{
+    while (d->count > 0 && d->digits[d->count - 1] == 0) {
+        d->count -= 1;
+    }
+    if (d->count == 0) {
+        d->point = 0;
+    }
+}
+
+static void json_decimal_right_shift(Json_Decimal *d, int k)
+{
+    int r = 0;
+    int w = 0;
+    uint64_t n = 0;
+
+    for (; (n >> k) == 0; r++) {
+        if (r >= d->count) {
+            if (n == 0) {
+                d->count = 0;
+                return;
+            }
+            while ((n >> k) == 0) {
+                n *= 10;
+                r++;
+            }
+            break;
+        }
+        n = n * 10 + d->digits[r];
+    }
+    d->point -= r - 1;
+
+    const uint64_t mask = ((uint64_t) 1 << k) - 1;
+    for (; r < d->count; r++) {
+        uint8_t digit = (uint8_t) (n >> k);
+        n &= mask;
+        d->digits[w++] = digit;
+        n = n * 10 + d->digits[r];
+    }
+
+    while (n > 0) {
+        uint8_t digit = (uint8_t) (n >> k);
+        n &= mask;
+        if (w < JSON_DECIMAL_CAPACITY) {
+            d->digits[w++] = digit;
+        } else if (digit > 0) {
+            d->truncated = 1;
+        }
+        n *= 10;
+    }
+
+    d->count = w;
+    json_decimal_trim(d);
+}
+
+static void json_decimal_left_shift(Json_Decimal *d, int k)
+{
+    int delta = json_decimal_left_cheats[k].delta;
+    const char *cutoff = json_decimal_left_cheats[k].cutoff;
+    for (int i = 0; cutoff[i] != '\0'; ++i) {
+        if (i >= d->count) {
+            delta -= 1;
+            break;
+        }
+        if (d->digits[i] != cutoff[i] - '0') {
+            if (d->digits[i] < cutoff[i] - '0') delta -= 1;
+            break;
+        }
+    }
+
+    int r = d->count;
+    int w = d->count + delta;
+    uint64_t n = 0;
+
+    for (r -= 1; r >= 0; r--) {
+        n += (uint64_t) d->digits[r] << k;
+        uint64_t quo = n / 10;
+        uint64_t rem = n - 10 * quo;
+        w -= 1;
+        if (w < JSON_DECIMAL_CAPACITY) {
+            d->digits[w] = (uint8_t) rem;
+        } else if (rem != 0) {
+            d->truncated = 1;
+        }
+        n = quo;
+    }
+
+    while (n > 0) {
+        uint64_t quo = n / 10;
+        uint64_t rem = n - 10 * quo;
+        w -= 1;
+        if (w < JSON_DECIMAL_CAPACITY) {
+            d->digits[w] = (uint8_t) rem;
+        } else if (rem != 0) {
+            d->truncated = 1;
+        }
+        n = quo;
+    }
+
+    d->count += delta;
+    if (d->count >= JSON_DECIMAL_CAPACITY) {
+        d->count = JSON_DECIMAL_CAPACITY;
+    }
+    d->point += delta;
+    json_decimal_trim(d);
+}
+
+static void json_decimal_shift(Json_Decimal *d, int k)
+{
+    if (d->count == 0) return;
+
+    if (k > 0) {
+        for (; k > JSON_DECIMAL_MAX_SHIFT; k -= JSON_DECIMAL_MAX_SHIFT) {
+            json_decimal_left_shift(d, JSON_DECIMAL_MAX_SHIFT);
+        }
+        json_decimal_left_shift(d, k);
+    } else if (k < 0) {
+        for (; k < -JSON_DECIMAL_MAX_SHIFT; k += JSON_DECIMAL_MAX_SHIFT) {
+            json_decimal_right_shift(d, JSON_DECIMAL_MAX_SHIFT);
+        }
+        json_decimal_right_shift(d, -k);
+    }
+}
+
+static int json_decimal_should_round_up(const Json_Decimal *d, int n)
+{
+    if (n < 0 || n >= d->count) return 0;
+    if (d->digits[n] == 5 && n + 1 == d->count) {
+        // Exactly halfway: round to even
+        if (d->truncated) return 1;
+        return n > 0 && d->digits[n - 1] % 2 == 1;
+    }
+    return d->digits[n] >= 5;
+}
+
+static uint64_t json_decimal_rounded_integer(const Json_Decimal *d)
+{
+    if (d->point > 20) return UINT64_MAX;
+
+    int i = 0;
+    uint64_t n = 0;
+    for (; i < d->point && i < d->count; ++i) {
+        n = n * 10 + d->digits[i];
+    }
+    for (; i < d->point; ++i) {
+        n *= 10;
+    }
+    if (json_decimal_should_round_up(d, d->point)) {
+        n += 1;
+    }
+    return n;
+}
+
+static void json_decimal_to_binary(Json_Decimal *d, uint64_t *mantissa, int64_t *power2)
+{
+    static const int powers[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+    static const int powers_count = sizeof(powers) / sizeof(powers[0]);
+
+    *mantissa = 0;
+    *power2 = 0;
+
+    if (d->count == 0 || d->point < -330) {
+        return;
+    }
+
+    if (d->point > 310) {
+        *power2 = JSON_DOUBLE_INFINITE_POWER;
+        return;
+    }
+
+    // Scale by powers of two until the decimal is in [0.5, 1)
+    int power = 0;
+    while (d->point > 0) {
+        int n = d->point >= powers_count ? 27 : powers[d->point];
+        json_decimal_shift(d, -n);
+        power += n;
+    }
+    while (d->point < 0 || (d->point == 0 && d->digits[0] < 5)) {
+        int n = -d->point >= powers_count ? 27 : powers[-d->point];
+        json_decimal_shift(d, n);
+        power -= n;
+    }
+
+    // [0.5, 1) -> [1, 2)
+    power -= 1;
+
+    const int min_exp = 1 - JSON_DOUBLE_EXPONENT_BIAS;
+    if (power < min_exp) {
+        int n = min_exp - power;
+        json_decimal_shift(d, -n);
+        power += n;
+    }
+
+    if (power + JSON_DOUBLE_EXPONENT_BIAS >= JSON_DOUBLE_INFINITE_POWER) {
+        *power2 = JSON_DOUBLE_INFINITE_POWER;
+        return;
+    }
+
+    json_decimal_shift(d, 1 + JSON_DOUBLE_MANTISSA_BITS);
+    uint64_t m = json_decimal_rounded_integer(d);
+
+    if (m == ((uint64_t) 2 << JSON_DOUBLE_MANTISSA_BITS)) {
+        m >>= 1;
+        power += 1;
+        if (power + JSON_DOUBLE_EXPONENT_BIAS >= JSON_DOUBLE_INFINITE_POWER) {
+            *power2 = JSON_DOUBLE_INFINITE_POWER;
+            return;
+        }
+    }
+
+    if ((m & ((uint64_t) 1 << JSON_DOUBLE_MANTISSA_BITS)) == 0) {
+        // Subnormal
+        *mantissa = m;
+        *power2 = 0;
+        return;
+    }
+
+    *mantissa = m & ~((uint64_t) 1 << JSON_DOUBLE_MANTISSA_BITS);
+    *power2 = power + JSON_DOUBLE_EXPONENT_BIAS;
+}
+
+static void json_decimal_push_digit(Json_Decimal *d, uint8_t digit)
+{
+    if (d->count < JSON_DECIMAL_CAPACITY) {
+        d->digits[d->count++] = digit;
+    } else if (digit != 0) {
+        d->truncated = 1;
+    }
+}
+
+static int64_t json_number_exponent_saturated(Tzozen_Str exponent)
+{
+    // Anything beyond this is zero or infinity anyway and we don't
+    // want to overflow on absurdly long exponents.
+    const int64_t limit = 1000000;
+
+    int64_t sign = 1;
+    if (exponent.len && (*exponent.data == '-' || *exponent.data == '+')) {
+        if (*exponent.data == '-') sign = -1;
+        tzozen_str_chop(&exponent, 1);
+    }
+
+    int64_t result = 0;
+    for (size_t i = 0; i < exponent.len; ++i) {
+        assert(json_isdigit(exponent.data[i]));
+        if (result < limit) {
+            result = result * 10 + (exponent.data[i] - '0');
+        }
+    }
+
+    return sign * result;
+}
+
+static double json_double_from_bits(int negative, uint64_t mantissa, int64_t power2)
+{
+    uint64_t bits = mantissa
+        | ((uint64_t) power2 << JSON_DOUBLE_MANTISSA_BITS)
+        | ((uint64_t) (negative != 0) << 63);
+    double result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+TZOZENDEF double json_number_to_double(Json_Number number)
+{
+    Tzozen_Str integer = number.integer;
+    int negative = 0;
+    if (integer.len && (*integer.data == '-' || *integer.data == '+')) {
+        negative = *integer.data == '-';
+        tzozen_str_chop(&integer, 1);
+    }
+
+    int64_t exponent = json_number_exponent_saturated(number.exponent);
+
+    // The first 19 significant digits always fit into uint64_t
+    uint64_t w = 0;
+    int taken = 0;
+    int64_t dropped = 0;
+    int truncated = 0;
+
+    for (size_t i = 0; i < integer.len + number.fraction.len; ++i) {
+        char c = i < integer.len ? integer.data[i] : number.fraction.data[i - integer.len];
+        assert(json_isdigit(c));
+        if (taken < 19) {
+            if (w != 0 || c != '0') {
+                w = w * 10 + (uint64_t) (c - '0');
+                taken += 1;
+            }
+        } else {
+            dropped += 1;
+            truncated |= c != '0';
+        }
+    }
+
+    if (w == 0) {
+        return negative ? -0.0 : 0.0;
+    }
+
+    int64_t q = exponent - (int64_t) number.fraction.len + dropped;
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    // Clinger's fast path: both w and 10^|q| are exact doubles, so a
+    // single correctly rounded operation gives the answer.
+    if (!truncated && w <= ((uint64_t) 1 << 53) && -22 <= q && q <= 22) {
+        static const double powers_of_ten[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        double result = (double) w;
+        if (q < 0) {
+            result /= powers_of_ten[-q];
+        } else {
+            result *= powers_of_ten[q];
+        }
+        return negative ? -result : result;
+    }
+#endif
+
+    if (q < JSON_POWER_OF_FIVE_MIN) {
+        return negative ? -0.0 : 0.0;
+    }
+
+    if (q > JSON_POWER_OF_FIVE_MAX) {
+        return json_double_from_bits(negative, 0, JSON_DOUBLE_INFINITE_POWER);
+    }
+
+    uint64_t mantissa;
+    int64_t power2;
+    json_eisel_lemire(w, q, &mantissa, &power2);
+
+    if (!truncated) {
+        return json_double_from_bits(negative, mantissa, power2);
+    }
+
+    // The real value is somewhere between w and w + 1. If both of them
+    // round to the same double that's the answer.
+    uint64_t mantissa_up;
+    int64_t power2_up;
+    json_eisel_lemire(w + 1, q, &mantissa_up, &power2_up);
+    if (mantissa == mantissa_up && power2 == power2_up) {
+        return json_double_from_bits(negative, mantissa, power2);
+    }
+
+    Json_Decimal decimal;
+    memset(&decimal, 0, sizeof(decimal));
+    int64_t point = 0;
+    for (size_t i = 0; i < integer.len; ++i) {
+        if (decimal.count == 0 && integer.data[i] == '0') continue;
+        json_decimal_push_digit(&decimal, (uint8_t) (integer.data[i] - '0'));
+        point += 1;
+    }
+    for (size_t i = 0; i < number.fraction.len; ++i) {
+        if (decimal.count == 0 && number.fraction.data[i] == '0') {
+            point -= 1;
+            continue;
+        }
+        json_decimal_push_digit(&decimal, (uint8_t) (number.fraction.data[i] - '0'));
+    }
+    point += exponent;
+    // Anything outside of this range is handled by the zero/infinity
+    // checks of json_decimal_to_binary().
+    if (point > 100000) point = 100000;
+    if (point < -100000) point = -100000;
+    decimal.point = (int) point;
+    json_decimal_trim(&decimal);
+
+    json_decimal_to_binary(&decimal, &mantissa, &power2);
+    return json_double_from_bits(negative, mantissa, power2);
+}
+
+// x = x * 10^k + add. Returns -1 on overflow.
+static int json_mul_pow10_add(uint64_t *x, int64_t k, uint64_t add)
+{
+    assert(k >= 0);
+
+    if (*x == 0) {
+        *x = add;
+        return 0;
+    }
+
+    if (k >= (int64_t) (sizeof(json_powers_of_ten_u64) / sizeof(json_powers_of_ten_u64[0]))) {
+        return -1;
+    }
+
+    uint64_t power = json_powers_of_ten_u64[k];
+    if (*x > (UINT64_MAX - add) / power) {
+        return -1;
+    }
+
+    *x = *x * power + add;
+    return 0;
+}
+
+// Truncates the fraction. Returns -1 if the number does not fit into
+// int64_t.
+TZOZENDEF int json_number_to_integer_checked(Json_Number number, int64_t *result)
+{
+    Tzozen_Str integer = number.integer;
+    int negative = 0;
+    if (integer.len && (*integer.data == '-' || *integer.data == '+')) {
+        negative = *integer.data == '-';
+        tzozen_str_chop(&integer, 1);
+    }
+
+    int64_t exponent = json_number_exponent_saturated(number.exponent);
+
+    if (exponent < 0) {
+        // Dividing by 10^-exponent is the same as dropping that many
+        // digits, and the rest may fit even if the whole thing doesn't.
+        integer.len -= (uint64_t) -exponent < integer.len ? (size_t) -exponent : integer.len;
+        exponent = 0;
+    }
+
+    uint64_t magnitude = 0;
+    if (json_digits_to_u64(integer, &magnitude) < 0) {
+        return -1;
+    }
+
+    if (exponent > 0) {
+        // The first `exponent` digits of the fraction move into the
+        // integer part.
+        size_t k = number.fraction.len;
+        if ((uint64_t) exponent < k) k = (size_t) exponent;
+
+        uint64_t fraction = 0;
+        if (json_digits_to_u64(tzozen_str_take(number.fraction, k), &fraction) < 0) {
+            return -1;
+        }
+
+        if (json_mul_pow10_add(&magnitude, (int64_t) k, fraction) < 0) {
+            return -1;
+        }
+
+        if (json_mul_pow10_add(&magnitude, exponent - (int64_t) k, 0) < 0) {
+            return -1;
+        }
+    }
+
+    return json_i64_from_magnitude(magnitude, negative, result);
+}
+
+// Saturates to INT64_MIN/INT64_MAX on overflow. Use
+// json_number_to_integer_checked() to find out about it.
+TZOZENDEF int64_t json_number_to_integer(Json_Number number)
+{
+    int64_t result = 0;
+    if (json_number_to_integer_checked(number, &result) < 0) {
+        return number.integer.len && *number.integer.data == '-' ? INT64_MIN : INT64_MAX;
+    }
+    return result;
+}
+
+TZOZENDEF Json_Result result_success(Tzozen_Str rest, Json_Value value)
+{
+    Json_Result result;
+    memset(&result, 0, sizeof(result));
+    result.value = value;
+    result.rest = rest;
+    return result;
+}
+
+TZOZENDEF Json_Result result_failure(Tzozen_Str rest, const char *message)
+{
+    Json_Result result;
+    memset(&result, 0, sizeof(result));
+    result.is_error = 1;
+    result.rest = rest;
+    result.message = message;
+    return result;
+}
+
+static int json_ctz64(uint64_t x)
+{
+    assert(x != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        n += 1;
+    }
+    return n;
+#endif
+}
+
+// Sets every bit to the XOR of all the bits at and below it. Turns a
+// mask of quotes into a mask of the string interiors.
+static uint64_t json_prefix_xor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+#if defined(TZOZEN_AVX2)
+#define JSON_SIMD_WIDTH 32
+typedef __m256i Json_Simd;
+#define json_simd_load(p) _mm256_loadu_si256((const __m256i *) (p))
+#define json_simd_mask(v) ((uint64_t) (uint32_t) _mm256_movemask_epi8(v))
+#define json_simd_eq(v, c) _mm256_cmpeq_epi8((v), _mm256_set1_epi8(c))
+#define json_simd_or(a, b) _mm256_or_si256((a), (b))
+#define json_simd_control(v) _mm256_cmpeq_epi8(_mm256_min_epu8((v), _mm256_set1_epi8(0x1F)), (v))
+#elif defined(TZOZEN_SSE2)
+#define JSON_SIMD_WIDTH 16
+typedef __m128i Json_Simd;
+#define json_simd_load(p) _mm_loadu_si128((const __m128i *) (p))
+#define json_simd_mask(v) ((uint64_t) (uint16_t) _mm_movemask_epi8(v))
+#define json_simd_eq(v, c) _mm_cmpeq_epi8((v), _mm_set1_epi8(c))
+#define json_simd_or(a, b) _mm_or_si128((a), (b))
+#define json_simd_control(v) _mm_cmpeq_epi8(_mm_min_epu8((v), _mm_set1_epi8(0x1F)), (v))
+#endif
+
+TZOZENDEF Json_Block_Masks json_classify_block(const char *block)
+{
+    Json_Block_Masks masks;
+    memset(&masks, 0, sizeof(masks));
+
+#ifdef JSON_SIMD_WIDTH
+    for (int i = 0; i < 64; i += JSON_SIMD_WIDTH) {
+        Json_Simd v = json_simd_load(block + i);
+
+        masks.quote |= json_simd_mask(json_simd_eq(v, '"')) << i;
+        masks.backslash |= json_simd_mask(json_simd_eq(v, '\\')) << i;
+
+        Json_Simd ws = json_simd_or(
+            json_simd_or(json_simd_eq(v, ' '), json_simd_eq(v, '\n')),
+            json_simd_or(json_simd_eq(v, '\r'), json_simd_eq(v, '\t')));
+        masks.whitespace |= json_simd_mask(ws) << i;
+
+        Json_Simd st = json_simd_or(
+            json_simd_or(
+                json_simd_or(json_simd_eq(v, '{'), json_simd_eq(v, '}')),
+                json_simd_or(json_simd_eq(v, '['), json_simd_eq(v, ']'))),
+            json_simd_or(json_simd_eq(v, ':'), json_simd_eq(v, ',')));
+        masks.structural |= json_simd_mask(st) << i;
+    }
+#else
+    for (int i = 0; i < 64; ++i) {
+        uint64_t bit = (uint64_t) 1 << i;
+        switch (block[i]) {
+        case '"': masks.quote |= bit; break;
+        case '\\': masks.backslash |= bit; break;
+        case ' ': case '\n': case '\r': case '\t':
+            masks.whitespace |= bit;
+            break;
+        case '{': case '}': case '[': case ']': case ':': case ',':
+            masks.structural |= bit;
+            break;
+        }
+    }
+#endif
+
+    return masks;
+}
+
+// Returns the offset of the first '"', '\\' or control character in
+// `data` or `len` if there is none. That is everything that stops a
+// run of bytes that can be copied out of a string literal as is.
+TZOZENDEF size_t json_string_scan(const char *data, size_t len)
+{
+    size_t i = 0;
+
+#if defined(JSON_SIMD_WIDTH)
+    for (; i + JSON_SIMD_WIDTH <= len; i += JSON_SIMD_WIDTH) {
+        Json_Simd v = json_simd_load(data + i);
+        Json_Simd stop = json_simd_or(
+            json_simd_or(json_simd_eq(v, '"'), json_simd_eq(v, '\\')),
+            json_simd_control(v));
+        uint64_t mask = json_simd_mask(stop);
+        if (mask) {
+            return i + json_ctz64(mask);
+        }
+    }
+#elif defined(TZOZEN_LITTLE_ENDIAN)
+    // SWAR: 8 bytes at a time. Only the lowest flagged byte is exact,
+    // which is the only one we need.
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t x;
+        memcpy(&x, data + i, sizeof(x));
+        uint64_t quote = x ^ (ones * '"');
+        uint64_t backslash = x ^ (ones * '\\');
+        uint64_t mask = ((quote - ones) & ~quote)
+            | ((backslash - ones) & ~backslash)
+            | ((x - ones * 0x20) & ~x);
+        mask &= highs;
+        if (mask) {
+            return i + json_ctz64(mask) / 8;
+        }
+    }
+#endif
+
+    for (; i < len; ++i) {
+        unsigned char c = (unsigned char) data[i];
+        if (c == '"' || c == '\\' || c < 0x20) {
+            return i;
+        }
+    }
+
+    return len;
+}
+
+// Returns the mask of the characters of the block escaped by the
+// backslashes. Backslashes are rare, so we just walk them.
+static uint64_t json_block_escaped(uint64_t backslash, uint64_t *carry)
+{
+    uint64_t escaped = *carry;
+    *carry = 0;
+    for (uint64_t bs = backslash; bs; bs &= bs - 1) {
+        int i = json_ctz64(bs);
+        if (escaped & ((uint64_t) 1 << i)) continue;
+        if (i == 63) {
+            *carry = 1;
+        } else {
+            escaped |= (uint64_t) 1 << (i + 1);
+        }
+    }
+    return escaped;
+}
+
+TZOZENDEF Json_Result parse_token(Tzozen_Str source, Tzozen_Str token,
+                        Json_Value value,
+                        const char *message)
 {
     if (tzozen_str_equal(tzozen_str_take(source, token.len), token)) {
         return result_success(tzozen_str_drop(source, token.len), value);
@@ -558,7 +2904,12 @@ TZOZENDEF int tzozen_str_clone(Tzozen_Memory *memory, Tzozen_Str string, Tzozen_
     return 0;
 }
 
-TZOZENDEF Json_Result parse_json_number(Tzozen_Memory *memory, Tzozen_Str source)
+static Tzozen_Memory *json_bytes_memory(Tzozen_Memory *memory, const Json_Options *options)
+{
+    return options->bytes != NULL ? options->bytes : memory;
+}
+
+TZOZENDEF Json_Result parse_json_number_with_options(Tzozen_Memory *memory, Tzozen_Str source, const Json_Options *options)
 {
     Tzozen_Str integer = {0, NULL};
     Tzozen_Str fraction = {0, NULL};
@@ -620,20 +2971,31 @@ TZOZENDEF Json_Result parse_json_number(Tzozen_Memory *memory, Tzozen_Str source
         }
     }
 
-    Tzozen_Str integer_clone = {0, NULL};
-    if (tzozen_str_clone(memory, integer, &integer_clone) < 0){
-        return result_failure(source, "Out of memory");
+    if (options->borrow_source) {
+        // The missing parts still point into the source right where
+        // they would have been.
+        if (fraction.data == NULL) fraction.data = integer.data + integer.len;
+        if (exponent.data == NULL) exponent.data = source.data;
+        return result_success(source, json_number(integer, fraction, exponent));
     }
 
-    Tzozen_Str fraction_clone = {0, NULL};
-    if (tzozen_str_clone(memory, fraction, &fraction_clone) < 0){
+    // All three parts are cloned into a single allocation to not make
+    // three tiny ones for every number.
+    char *clone = (char *) memory_alloc(json_bytes_memory(memory, options), integer.len + fraction.len + exponent.len);
+    if (clone == NULL) {
         return result_failure(source, "Out of memory");
     }
 
-    Tzozen_Str exponent_clone = {0, NULL};
-    if (tzozen_str_clone(memory, exponent, &exponent_clone) < 0){
-        return result_failure(source, "Out of memory");
-    }
+    Tzozen_Str integer_clone = {integer.len, clone};
+    memcpy(clone, integer.data, integer.len);
+    clone += integer.len;
+
+    Tzozen_Str fraction_clone = {fraction.len, clone};
+    if (fraction.len) memcpy(clone, fraction.data, fraction.len);
+    clone += fraction.len;
+
+    Tzozen_Str exponent_clone = {exponent.len, clone};
+    if (exponent.len) memcpy(clone, exponent.data, exponent.len);
 
     return result_success(
         source,
@@ -643,6 +3005,13 @@ TZOZENDEF Json_Result parse_json_number(Tzozen_Memory *memory, Tzozen_Str source
             exponent_clone));
 }
 
+TZOZENDEF Json_Result parse_json_number(Tzozen_Memory *memory, Tzozen_Str source)
+{
+    Json_Options options;
+    memset(&options, 0, sizeof(options));
+    return parse_json_number_with_options(memory, source, &options);
+}
+
 TZOZENDEF Json_Result parse_json_string_literal(Tzozen_Str source)
 {
     if (source.len == 0 || *source.data != '"') {
@@ -653,7 +3022,19 @@ TZOZENDEF Json_Result parse_json_string_literal(Tzozen_Str source)
 
     Tzozen_Str s = { 0, source.data };
 
-    while (source.len && *source.data != '"') {
+    for (;;) {
+        size_t n = json_string_scan(source.data, source.len);
+        s.len += n;
+        tzozen_str_chop(&source, n);
+
+        if (source.len == 0) {
+            return result_failure(source, "Expected '\"'");
+        }
+
+        if (*source.data == '"') {
+            break;
+        }
+
         if (*source.data == '\\') {
             s.len++;
             tzozen_str_chop(&source, 1);
@@ -667,10 +3048,6 @@ TZOZENDEF Json_Result parse_json_string_literal(Tzozen_Str source)
         tzozen_str_chop(&source, 1);
     }
 
-    if (source.len == 0) {
-        return result_failure(source, "Expected '\"'");
-    }
-
     tzozen_str_chop(&source, 1);
 
     return result_success(source, json_string(s));
@@ -831,308 +3208,3200 @@ TZOZENDEF Json_Result parse_escape_sequence(Tzozen_Memory *memory, Tzozen_Str so
     return result_success(source, json_string(s));
 }
 
-TZOZENDEF Json_Result parse_json_string(Tzozen_Memory *memory, Tzozen_Str source)
+// Decodes the contents of the string literal into the buffer, which
+// must fit the whole literal. Only checks the literal if the buffer is
+// NULL. The `source_end` is needed for the errors.
+static Json_Result json_decode_string(Tzozen_Str source, const char *source_end,
+                                      char *buffer, size_t *buffer_size)
+{
+    Json_Result result;
+    const size_t buffer_capacity = source.len;
+    size_t n = json_string_scan(source.data, source.len);
+    *buffer_size = 0;
+
+    for (;;) {
+        assert(*buffer_size + n <= buffer_capacity);
+        if (buffer != NULL) memcpy(buffer + *buffer_size, source.data, n);
+        *buffer_size += n;
+        tzozen_str_chop(&source, n);
+
+        if (source.len == 0) {
+            break;
+        }
+
+        if (*source.data != '\\') {
+            Tzozen_Str at = {(size_t) (source_end - source.data), source.data};
+            return result_failure(at, "Unescaped control character in string");
+        }
+
+        // The decoded escape sequence is copied to the buffer right
+        // away, so it does not have to take space in the memory.
+        uint8_t escape_buffer[UTF8_CHUNK_CAPACITY];
+        Tzozen_Memory escape_memory = tzozen_memory(escape_buffer, sizeof(escape_buffer));
+        result = parse_escape_sequence(&escape_memory, source);
+        if (result.is_error) return result;
+        assert(result.value.type == JSON_STRING);
+        assert(*buffer_size + result.value.string.len <= buffer_capacity);
+        if (buffer != NULL) {
+            memcpy(buffer + *buffer_size,
+                   result.value.string.data,
+                   result.value.string.len);
+        }
+        *buffer_size += result.value.string.len;
+
+        source = result.rest;
+        n = json_string_scan(source.data, source.len);
+    }
+
+    return result_success(source, json_null());
+}
+
+TZOZENDEF Json_Result parse_json_string_with_options(Tzozen_Memory *memory, Tzozen_Str source, const Json_Options *options)
 {
+    // Most of the strings have no escape sequences. Then the same scan
+    // that finds the closing quote proves that the contents can be
+    // taken as they are.
+    if (source.len > 0 && *source.data == '"') {
+        size_t n = json_string_scan(source.data + 1, source.len - 1);
+        if (n < source.len - 1 && source.data[1 + n] == '"') {
+            Tzozen_Str contents = {n, source.data + 1};
+            Tzozen_Str rest = tzozen_str_drop(source, n + 2);
+            if (options->borrow_source) {
+                return result_success(rest, json_string(contents));
+            }
+
+            char *buffer = (char *) memory_alloc(json_bytes_memory(memory, options), n);
+            if (buffer == NULL) {
+                return result_failure(contents, "Out of memory");
+            }
+            memcpy(buffer, contents.data, n);
+            contents.data = buffer;
+            return result_success(rest, json_string(contents));
+        }
+    }
+
     Json_Result result = parse_json_string_literal(source);
     if (result.is_error) return result;
     assert(result.value.type == JSON_STRING);
 
-    const size_t buffer_capacity = result.value.string.len;
+    const char *source_end = source.data + source.len;
     source = result.value.string;
     Tzozen_Str rest = result.rest;
 
-    char *buffer = (char *)memory_alloc(memory, buffer_capacity);
+    // TODO: json parser is not aware of the input encoding
+    if (options->borrow_source && json_string_scan(source.data, source.len) == source.len) {
+        return result_success(rest, json_string(source));
+    }
+
+    char *buffer = (char *)memory_alloc(json_bytes_memory(memory, options), source.len);
     if (buffer == NULL) {
         return result_failure(source, "Out of memory");
     }
+
     size_t buffer_size = 0;
+    result = json_decode_string(source, source_end, buffer, &buffer_size);
+    if (result.is_error) return result;
 
-    while (source.len) {
-        if (*source.data == '\\') {
-            result = parse_escape_sequence(memory, source);
-            if (result.is_error) return result;
-            assert(result.value.type == JSON_STRING);
-            assert(buffer_size + result.value.string.len <= buffer_capacity);
-            memcpy(buffer + buffer_size,
-                   result.value.string.data,
-                   result.value.string.len);
-            buffer_size += result.value.string.len;
+    Tzozen_Str result_string = {buffer_size, buffer};
+    return result_success(rest, json_string(result_string));
+}
 
-            source = result.rest;
-        } else {
-            // TODO: json parser is not aware of the input encoding
-            assert(buffer_size < buffer_capacity);
-            buffer[buffer_size++] = *source.data;
-            tzozen_str_chop(&source, 1);
+TZOZENDEF Json_Result parse_json_string(Tzozen_Memory *memory, Tzozen_Str source)
+{
+    Json_Options options;
+    memset(&options, 0, sizeof(options));
+    return parse_json_string_with_options(memory, source, &options);
+}
+
+TZOZENDEF int json_intern_init(Tzozen_Memory *memory, Json_Intern *intern, size_t capacity, Json_Hash_Seed seed)
+{
+    size_t actual_capacity = 4;
+    while (actual_capacity < capacity) actual_capacity *= 2;
+
+    Json_Intern_Slot *slots = TZOZEN_ALLOC(memory, Json_Intern_Slot, actual_capacity);
+    if (slots == NULL) {
+        return -1;
+    }
+    memset(slots, 0, sizeof(Json_Intern_Slot) * actual_capacity);
+
+    memset(intern, 0, sizeof(*intern));
+    intern->seed = seed;
+    intern->capacity = actual_capacity;
+    intern->slots = slots;
+
+    return 0;
+}
+
+// Returns the interned copy of the string, or the string itself if it
+// is seen for the first time (and remembers it if there is still room).
+TZOZENDEF Tzozen_Str json_intern(Json_Intern *intern, Tzozen_Str string)
+{
+    uint64_t hash = json_hash(intern->seed, string);
+    size_t i = (size_t) hash & (intern->capacity - 1);
+    while (intern->slots[i].string.data != NULL) {
+        if (intern->slots[i].hash == hash && tzozen_str_equal(intern->slots[i].string, string)) {
+            return intern->slots[i].string;
         }
+        i = (i + 1) & (intern->capacity - 1);
     }
 
-    Tzozen_Str result_string = {buffer_size, buffer};
-    return result_success(rest, json_string(result_string));
+    // NULL data marks the empty slots
+    if (string.data != NULL && (intern->size + 1) * 4 <= intern->capacity * 3) {
+        intern->slots[i].hash = hash;
+        intern->slots[i].string = string;
+        intern->size += 1;
+    }
+
+    return string;
+}
+
+// Where a parse starts in its memories
+typedef struct {
+    Tzozen_Memory_Mark memory;
+    Tzozen_Memory_Mark bytes;
+} Json_Parse_Mark;
+
+static Json_Parse_Mark json_parse_save(const Tzozen_Memory *memory, const Json_Options *options)
+{
+    Json_Parse_Mark mark;
+    memset(&mark, 0, sizeof(mark));
+    mark.memory = tzozen_memory_save(memory);
+    if (options->bytes != NULL) {
+        mark.bytes = tzozen_memory_save(options->bytes);
+    }
+    return mark;
+}
+
+// Gives back the memory of a failed parse
+static void json_parse_rollback(Tzozen_Memory *memory, const Json_Options *options, Json_Parse_Mark mark)
+{
+    // The intern table may point to the new strings already
+    if (options->intern != NULL) {
+        return;
+    }
+
+    tzozen_memory_rollback(memory, mark.memory);
+    if (options->bytes != NULL) {
+        tzozen_memory_rollback(options->bytes, mark.bytes);
+    }
+}
+
+static Json_Result json_parse_interned_string(Tzozen_Memory *memory, Tzozen_Str source,
+                                              const Json_Options *options, int is_key)
+{
+    // Every string and key of the default parse goes through here
+    if (options->intern == NULL) {
+        return parse_json_string_with_options(memory, source, options);
+    }
+
+    Tzozen_Memory *bytes = json_bytes_memory(memory, options);
+    Tzozen_Memory_Mark mark = tzozen_memory_save(bytes);
+
+    Json_Result result = parse_json_string_with_options(memory, source, options);
+    if (result.is_error) {
+        return result;
+    }
+
+    if (!is_key && result.value.string.len > options->intern->max_value_len) {
+        return result;
+    }
+
+    Tzozen_Str interned = json_intern(options->intern, result.value.string);
+    if (interned.data != result.value.string.data) {
+        // The fresh copy is the last thing in the memory, give it back
+        tzozen_memory_rollback(bytes, mark);
+        result.value.string = interned;
+    }
+
+    return result;
+}
+
+TZOZENDEF Json_Result parse_json_array_with_options(Tzozen_Memory *memory, Tzozen_Str source, int level, const Json_Options *options)
+{
+    if(source.len == 0 || *source.data != '[') {
+        return result_failure(source, "Expected '['");
+    }
+
+    return parse_json_value_with_depth_and_options(memory, source, level, options);
 }
 
 TZOZENDEF Json_Result parse_json_array(Tzozen_Memory *memory, Tzozen_Str source, int level)
 {
-    assert(memory);
+    Json_Options options;
+    memset(&options, 0, sizeof(options));
+    return parse_json_array_with_options(memory, source, level, &options);
+}
+
+TZOZENDEF Json_Result parse_json_object_with_options(Tzozen_Memory *memory, Tzozen_Str source, int level, const Json_Options *options)
+{
+    if (source.len == 0 || *source.data != '{') {
+        return result_failure(source, "Expected '{'");;
+    }
+
+    return parse_json_value_with_depth_and_options(memory, source, level, options);
+}
+
+TZOZENDEF Json_Result parse_json_object(Tzozen_Memory *memory, Tzozen_Str source, int level)
+{
+    Json_Options options;
+    memset(&options, 0, sizeof(options));
+    return parse_json_object_with_options(memory, source, level, &options);
+}
+
+// Events of json_parse_events(), the loop that the tree, the SAX, the
+// cells and the measuring parsers share. The loop only checks the
+// structure of the document: the strings, the numbers and the keys are
+// parsed by the events from the beginning of the source, so every
+// parser decides how much of them to keep. Returning a negative number or an error stops
+// the parsing, the numbers with the `message`.
+typedef struct {
+    const char *message;
+    // `null`, `true` and `false`
+    int (*literal)(void *data, Json_Value value);
+    Json_Result (*string)(void *data, Tzozen_Str source);
+    Json_Result (*number)(void *data, Tzozen_Str source);
+    Json_Result (*key)(void *data, Tzozen_Str source);
+    int (*open)(void *data, Json_Type type);
+    // Returns the type of the container that is open after this one is
+    // closed, JSON_NULL at the top level. The loop keeps no stack.
+    int (*close)(void *data);
+} Json_Events;
+
+// Instead of recursing into the nested arrays and objects the loop
+// keeps going from the innermost open container every time a value is
+// done. At most `capacity` containers are open at the same time.
+static Json_Result json_parse_events(Tzozen_Str source, const Json_Events *events,
+                                     void *data, size_t capacity)
+{
+    size_t depth = 0;
+    int type = JSON_NULL;
+    Json_Result result;
+
+parse_value:
+    if (depth >= capacity) {
+        return result_failure(source, "Reached the max limit of depth");
+    }
+
+    source = tzozen_str_trim_begin(source);
+
+    if (source.len == 0) {
+        return result_failure(source, "EOF");
+    }
+
+    switch (*source.data) {
+    case 'n':
+        result = parse_token(source, TSTR("null"), json_null(), "Expected `null`");
+        goto literal_parsed;
+    case 't':
+        result = parse_token(source, TSTR("true"), json_true(), "Expected `true`");
+        goto literal_parsed;
+    case 'f':
+        result = parse_token(source, TSTR("false"), json_false(), "Expected `false`");
+        goto literal_parsed;
+    case '"':
+        result = events->string(data, source);
+        break;
+    case '[':
+    case '{':
+        type = *source.data == '[' ? JSON_ARRAY : JSON_OBJECT;
+        if (events->open(data, (Json_Type) type) < 0) {
+            return result_failure(source, events->message);
+        }
+        depth += 1;
+
+        tzozen_str_chop(&source, 1);
+        source = tzozen_str_trim_begin(source);
+
+        if (source.len == 0) {
+            return result_failure(source, type == JSON_ARRAY ? "Expected ']'" : "Expected '}'");
+        } else if (*source.data == (type == JSON_ARRAY ? ']' : '}')) {
+            goto container_closed;
+        }
+
+        if (type == JSON_ARRAY) {
+            goto parse_value;
+        }
+        goto parse_key;
+    default:
+        result = events->number(data, source);
+        break;
+    }
+
+    if (result.is_error) {
+        return result;
+    }
+    source = result.rest;
+    goto value_parsed;
+
+literal_parsed:
+    if (result.is_error) {
+        return result;
+    }
+    if (events->literal(data, result.value) < 0) {
+        return result_failure(source, events->message);
+    }
+    source = result.rest;
+
+value_parsed:
+    if (depth == 0) {
+        return result_success(source, json_null());
+    }
+
+    source = tzozen_str_trim_begin(source);
+
+    if (type == JSON_ARRAY) {
+        if (source.len == 0) {
+            return result_failure(source, "Expected ']' or ','");
+        }
+
+        if (*source.data == ']') {
+            goto container_closed;
+        }
+
+        if (*source.data != ',') {
+            return result_failure(source, "Expected ']' or ','");
+        }
+
+        source = tzozen_str_trim_begin(tzozen_str_drop(source, 1));
+
+        if (source.len == 0) {
+            return result_failure(source, "EOF");
+        }
+
+        goto parse_value;
+    }
+
+    if (source.len == 0) {
+        return result_failure(source, "Expected '}' or ','");
+    }
+
+    if (*source.data == '}') {
+        goto container_closed;
+    }
+
+    if (*source.data != ',') {
+        return result_failure(source, "Expected '}' or ','");
+    }
+
+    tzozen_str_chop(&source, 1);
+
+    if (source.len == 0) {
+        return result_failure(source, "EOF");
+    }
+
+parse_key:
+    source = tzozen_str_trim_begin(source);
+
+    result = events->key(data, source);
+    if (result.is_error) {
+        return result;
+    }
+
+    source = tzozen_str_trim_begin(result.rest);
+
+    if (source.len == 0 || *source.data != ':') {
+        return result_failure(source, "Expected ':'");
+    }
+
+    tzozen_str_chop(&source, 1);
+    goto parse_value;
+
+container_closed:
+    tzozen_str_chop(&source, 1);
+    depth -= 1;
+    type = events->close(data);
+    if (type < 0) {
+        return result_failure(source, events->message);
+    }
+    goto value_parsed;
+}
+
+// The tree that json_parse_events() builds for json_parse_iteratively()
+typedef struct {
+    Tzozen_Memory *memory;
+    const Json_Options *options;
+    Json_Frame *stack;
+    size_t depth;
+    // The whole document once the parsing is done
+    Json_Value value;
+} Json_Builder;
+
+// Adds the finished value to the innermost container. Returns the type
+// of the container, JSON_NULL at the top level.
+static int json_builder_add(Json_Builder *builder, Json_Value value)
+{
+    if (builder->depth == 0) {
+        builder->value = value;
+        return JSON_NULL;
+    }
+
+    Json_Frame *frame = &builder->stack[builder->depth - 1];
+    if (frame->container.type == JSON_ARRAY) {
+        if (json_array_push(builder->memory, &frame->container.array, value) < 0) {
+            return -1;
+        }
+    } else if (json_object_push(builder->memory, &frame->container.object, frame->key, value) < 0) {
+        return -1;
+    }
+
+    return frame->container.type;
+}
+
+static int json_builder_literal(void *data, Json_Value value)
+{
+    return json_builder_add((Json_Builder *) data, value);
+}
+
+static Json_Result json_builder_string(void *data, Tzozen_Str source)
+{
+    Json_Builder *builder = (Json_Builder *) data;
+    Json_Result result = json_parse_interned_string(builder->memory, source, builder->options, 0);
+    if (!result.is_error && json_builder_add(builder, result.value) < 0) {
+        return result_failure(source, "Out of memory");
+    }
+    return result;
+}
+
+static Json_Result json_builder_number(void *data, Tzozen_Str source)
+{
+    Json_Builder *builder = (Json_Builder *) data;
+    Json_Result result = parse_json_number_with_options(builder->memory, source, builder->options);
+    if (!result.is_error && json_builder_add(builder, result.value) < 0) {
+        return result_failure(source, "Out of memory");
+    }
+    return result;
+}
+
+static Json_Result json_builder_key(void *data, Tzozen_Str source)
+{
+    Json_Builder *builder = (Json_Builder *) data;
+    Json_Result result = json_parse_interned_string(builder->memory, source, builder->options, 1);
+    if (!result.is_error) {
+        assert(result.value.type == JSON_STRING);
+        builder->stack[builder->depth - 1].key = result.value.string;
+    }
+    return result;
+}
+
+static int json_builder_open(void *data, Json_Type type)
+{
+    Json_Builder *builder = (Json_Builder *) data;
+    Json_Frame *frame = &builder->stack[builder->depth++];
+    memset(frame, 0, sizeof(*frame));
+    frame->container = type == JSON_ARRAY ? json_array_empty() : json_object_empty();
+    return 0;
+}
+
+static int json_builder_close(void *data)
+{
+    Json_Builder *builder = (Json_Builder *) data;
+    const Json_Options *options = builder->options;
+    Json_Value container = builder->stack[--builder->depth].container;
+
+    if (container.type == JSON_ARRAY) {
+        if (options->finalize_containers && json_array_finalize(builder->memory, &container.array) < 0) {
+            return -1;
+        }
+    } else {
+        if (options->finalize_containers && json_object_finalize(builder->memory, &container.object) < 0) {
+            return -1;
+        }
+        if (options->hash_threshold > 0
+            && container.object.size >= options->hash_threshold
+            && json_object_hash(builder->memory, &container.object, options->hash_seed) < 0) {
+            return -1;
+        }
+    }
+
+    return json_builder_add(builder, container);
+}
+
+static const Json_Events json_builder_events = {
+    "Out of memory",
+    json_builder_literal,
+    json_builder_string,
+    json_builder_number,
+    json_builder_key,
+    json_builder_open,
+    json_builder_close,
+};
+
+static Json_Result json_parse_iteratively(Tzozen_Memory *memory, Tzozen_Str source, int level,
+                                          const Json_Options *options,
+                                          Json_Frame *stack, size_t capacity)
+{
+    assert(memory);
+    assert(level >= 0);
+
+    Json_Builder builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.memory = memory;
+    builder.options = options;
+    builder.stack = stack;
+
+    size_t levels_left = (size_t) level < capacity ? capacity - (size_t) level : 0;
+    Json_Result result = json_parse_events(source, &json_builder_events, &builder, levels_left);
+    if (!result.is_error) {
+        result.value = builder.value;
+    }
+
+    return result;
+}
+
+TZOZENDEF Json_Result parse_json_value_with_depth_and_options(Tzozen_Memory *memory, Tzozen_Str source, int level, const Json_Options *options)
+{
+    if (options->stack != NULL) {
+        return json_parse_iteratively(memory, source, level, options,
+                                      options->stack, options->stack_capacity);
+    }
+
+    Json_Frame stack[JSON_DEPTH_MAX_LIMIT];
+    return json_parse_iteratively(memory, source, level, options, stack, JSON_DEPTH_MAX_LIMIT);
+}
+
+TZOZENDEF Json_Result parse_json_value_with_depth(Tzozen_Memory *memory, Tzozen_Str source, int level)
+{
+    Json_Options options;
+    memset(&options, 0, sizeof(options));
+    return parse_json_value_with_depth_and_options(memory, source, level, &options);
+}
+
+// TODO: parse_json_value is not aware of input encoding
+TZOZENDEF Json_Result parse_json_value_with_options(Tzozen_Memory *memory, Tzozen_Str source, const Json_Options *options)
+{
+    Json_Parse_Mark mark = json_parse_save(memory, options);
+
+    Json_Result result = parse_json_value_with_depth_and_options(memory, source, 0, options);
+    if (result.is_error) {
+        json_parse_rollback(memory, options, mark);
+    }
+
+    return result;
+}
+
+TZOZENDEF Json_Result parse_json_value(Tzozen_Memory *memory, Tzozen_Str source)
+{
+    Json_Options options;
+    memset(&options, 0, sizeof(options));
+    return parse_json_value_with_options(memory, source, &options);
+}
+
+// Same padding as memory_alloc_aligned() from an aligned buffer
+static void json_measure_node(size_t *size, size_t node_size, size_t alignment)
+{
+    *size = (*size + alignment - 1) / alignment * alignment + node_size;
+}
+
+#define JSON_MEASURE_NODE(size, type, count) \
+    json_measure_node((size), sizeof(type) * (count), TZOZEN_ALIGNOF(type))
+
+static Json_Result json_measure_string(Tzozen_Str source, const Json_Options *options, size_t *size)
+{
+    Json_Result result = parse_json_string_literal(source);
+    if (result.is_error) return result;
+
+    Tzozen_Str literal = result.value.string;
+    Tzozen_Str rest = result.rest;
+
+    if (options->borrow_source && json_string_scan(literal.data, literal.len) == literal.len) {
+        return result;
+    }
+
+    // parse_json_string_with_options() takes the whole literal for the decoded string
+    size_t decoded_size = 0;
+    result = json_decode_string(literal, source.data + source.len, NULL, &decoded_size);
+    if (result.is_error) return result;
+
+    *size += literal.len;
+    return result_success(rest, json_null());
+}
+
+// What json_measure() adds up from the events of json_parse_events().
+// The frames only keep the types and the sizes of the containers. The
+// `bytes` is the same as the `size` unless Json_Options.bytes is set.
+typedef struct {
+    const Json_Options *options;
+    // The numbers are only checked, never copied
+    Json_Options number_options;
+    Json_Frame *stack;
+    size_t depth;
+    size_t *size;
+    size_t *bytes;
+} Json_Measurer;
+
+// Same as json_builder_add()
+static int json_measurer_add(Json_Measurer *measurer)
+{
+    if (measurer->depth == 0) {
+        return JSON_NULL;
+    }
+
+    Json_Frame *frame = &measurer->stack[measurer->depth - 1];
+    if (frame->container.type == JSON_ARRAY) {
+        JSON_MEASURE_NODE(measurer->size, Json_Array_Elem, 1);
+        frame->container.array.size += 1;
+    } else {
+        JSON_MEASURE_NODE(measurer->size, Json_Object_Elem, 1);
+        frame->container.object.size += 1;
+    }
+
+    return frame->container.type;
+}
+
+static int json_measurer_literal(void *data, Json_Value value)
+{
+    (void) value;
+    return json_measurer_add((Json_Measurer *) data);
+}
+
+static Json_Result json_measurer_string(void *data, Tzozen_Str source)
+{
+    Json_Measurer *measurer = (Json_Measurer *) data;
+    Json_Result result = json_measure_string(source, measurer->options, measurer->bytes);
+    if (!result.is_error) {
+        json_measurer_add(measurer);
+    }
+    return result;
+}
+
+static Json_Result json_measurer_number(void *data, Tzozen_Str source)
+{
+    Json_Measurer *measurer = (Json_Measurer *) data;
+    Json_Result result = parse_json_number_with_options(NULL, source, &measurer->number_options);
+    if (!result.is_error) {
+        if (!measurer->options->borrow_source) {
+            *measurer->bytes += result.value.number.integer.len
+                + result.value.number.fraction.len
+                + result.value.number.exponent.len;
+        }
+        json_measurer_add(measurer);
+    }
+    return result;
+}
+
+static Json_Result json_measurer_key(void *data, Tzozen_Str source)
+{
+    Json_Measurer *measurer = (Json_Measurer *) data;
+    return json_measure_string(source, measurer->options, measurer->bytes);
+}
+
+static int json_measurer_open(void *data, Json_Type type)
+{
+    Json_Measurer *measurer = (Json_Measurer *) data;
+    Json_Frame *frame = &measurer->stack[measurer->depth++];
+    memset(frame, 0, sizeof(*frame));
+    frame->container.type = type;
+    return 0;
+}
+
+// Same as json_builder_close()
+static int json_measurer_close(void *data)
+{
+    Json_Measurer *measurer = (Json_Measurer *) data;
+    const Json_Options *options = measurer->options;
+    Json_Value container = measurer->stack[--measurer->depth].container;
+
+    if (container.type == JSON_ARRAY) {
+        if (options->finalize_containers && container.array.size > 0) {
+            JSON_MEASURE_NODE(measurer->size, Json_Array_Elem*, container.array.size);
+        }
+    } else {
+        size_t object_size = container.object.size;
+        if (options->finalize_containers && object_size > 0) {
+            JSON_MEASURE_NODE(measurer->size, Json_Object_Elem*, object_size);
+        }
+        if (options->hash_threshold > 0 && object_size >= options->hash_threshold) {
+            // Same capacity as in json_object_hash()
+            size_t table_capacity = 4;
+            while (table_capacity < object_size * 2) table_capacity *= 2;
+            JSON_MEASURE_NODE(measurer->size, Json_Object_Table, 1);
+            JSON_MEASURE_NODE(measurer->size, Json_Object_Slot, table_capacity);
+        }
+    }
+
+    return json_measurer_add(measurer);
+}
+
+static const Json_Events json_measurer_events = {
+    NULL,
+    json_measurer_literal,
+    json_measurer_string,
+    json_measurer_number,
+    json_measurer_key,
+    json_measurer_open,
+    json_measurer_close,
+};
+
+static Json_Result json_measure_iteratively(Tzozen_Str source, const Json_Options *options,
+                                            Json_Frame *stack, size_t capacity,
+                                            size_t *size, size_t *bytes)
+{
+    Json_Measurer measurer;
+    memset(&measurer, 0, sizeof(measurer));
+    measurer.options = options;
+    measurer.number_options.borrow_source = 1;
+    measurer.stack = stack;
+    measurer.size = size;
+    measurer.bytes = bytes;
+
+    return json_parse_events(source, &json_measurer_events, &measurer, capacity);
+}
+
+#undef JSON_MEASURE_NODE
+
+TZOZENDEF Json_Result json_measure(Tzozen_Str source, const Json_Options *options,
+                                   size_t *size, size_t *bytes_size)
+{
+    assert(size);
+
+    Json_Options default_options;
+    if (options == NULL) {
+        memset(&default_options, 0, sizeof(default_options));
+        options = &default_options;
+    }
+
+    size_t separate_bytes = 0;
+    size_t *bytes = options->bytes != NULL ? &separate_bytes : size;
+    *size = 0;
+
+    Json_Result result;
+    if (options->stack != NULL) {
+        result = json_measure_iteratively(source, options, options->stack, options->stack_capacity, size, bytes);
+    } else {
+        Json_Frame stack[JSON_DEPTH_MAX_LIMIT];
+        result = json_measure_iteratively(source, options, stack, JSON_DEPTH_MAX_LIMIT, size, bytes);
+    }
+
+    if (bytes_size != NULL) {
+        *bytes_size = separate_bytes;
+    }
+
+    return result;
+}
+
+#define JSON_SAX_CALL(callback, ...)                                    \
+    ((callback) == NULL || (callback)(__VA_ARGS__) >= 0 ? 0 : -1)
+
+// What parse_json_sax() passes from json_parse_events() to the
+// callbacks. The stack only keeps a byte with the type of every open
+// container.
+typedef struct {
+    Tzozen_Memory *scratch;
+    const Json_Options *options;
+    const Json_Sax *sax;
+    uint8_t *types;
+    size_t depth;
+} Json_Sax_Parser;
+
+static int json_sax_literal(void *data, Json_Value value)
+{
+    const Json_Sax *sax = ((Json_Sax_Parser *) data)->sax;
+    if (value.type == JSON_NULL) {
+        return JSON_SAX_CALL(sax->null, sax->data);
+    }
+    return JSON_SAX_CALL(sax->boolean, sax->data, value.boolean);
+}
+
+// The strings with escape sequences are decoded into the scratch and
+// freed right after their event
+static Json_Result json_sax_string_event(Json_Sax_Parser *parser, Tzozen_Str source,
+                                         int (*callback)(void *data, Tzozen_Str string))
+{
+    Tzozen_Memory_Mark mark = tzozen_memory_save(parser->scratch);
+    Json_Result result = parse_json_string_with_options(parser->scratch, source, parser->options);
+    int status = result.is_error ? 0 : JSON_SAX_CALL(callback, parser->sax->data, result.value.string);
+    tzozen_memory_rollback(parser->scratch, mark);
+
+    if (status < 0) {
+        return result_failure(source, "Stopped by the callback");
+    }
+    return result;
+}
+
+static Json_Result json_sax_string(void *data, Tzozen_Str source)
+{
+    Json_Sax_Parser *parser = (Json_Sax_Parser *) data;
+    return json_sax_string_event(parser, source, parser->sax->string);
+}
+
+static Json_Result json_sax_key(void *data, Tzozen_Str source)
+{
+    Json_Sax_Parser *parser = (Json_Sax_Parser *) data;
+    return json_sax_string_event(parser, source, parser->sax->key);
+}
+
+static Json_Result json_sax_number(void *data, Tzozen_Str source)
+{
+    Json_Sax_Parser *parser = (Json_Sax_Parser *) data;
+    const Json_Sax *sax = parser->sax;
+    Json_Result result = parse_json_number_with_options(parser->scratch, source, parser->options);
+    if (!result.is_error && JSON_SAX_CALL(sax->number, sax->data, result.value.number) < 0) {
+        return result_failure(source, "Stopped by the callback");
+    }
+    return result;
+}
+
+static int json_sax_open(void *data, Json_Type type)
+{
+    Json_Sax_Parser *parser = (Json_Sax_Parser *) data;
+    const Json_Sax *sax = parser->sax;
+    parser->types[parser->depth++] = (uint8_t) type;
+    return type == JSON_ARRAY
+        ? JSON_SAX_CALL(sax->start_array, sax->data)
+        : JSON_SAX_CALL(sax->start_object, sax->data);
+}
+
+static int json_sax_close(void *data)
+{
+    Json_Sax_Parser *parser = (Json_Sax_Parser *) data;
+    const Json_Sax *sax = parser->sax;
+    int status = parser->types[--parser->depth] == JSON_ARRAY
+        ? JSON_SAX_CALL(sax->end_array, sax->data)
+        : JSON_SAX_CALL(sax->end_object, sax->data);
+    if (status < 0) {
+        return status;
+    }
+    return parser->depth > 0 ? (int) parser->types[parser->depth - 1] : (int) JSON_NULL;
+}
+
+#undef JSON_SAX_CALL
+
+static const Json_Events json_sax_events = {
+    "Stopped by the callback",
+    json_sax_literal,
+    json_sax_string,
+    json_sax_number,
+    json_sax_key,
+    json_sax_open,
+    json_sax_close,
+};
+
+TZOZENDEF Json_Result parse_json_sax(Tzozen_Memory *scratch, Tzozen_Str source, const Json_Options *options, const Json_Sax *sax)
+{
+    assert(scratch);
+    assert(sax);
+
+    Json_Options sax_options;
+    memset(&sax_options, 0, sizeof(sax_options));
+    sax_options.borrow_source = 1;
+
+    uint8_t types[JSON_DEPTH_MAX_LIMIT];
+    Json_Sax_Parser parser;
+    memset(&parser, 0, sizeof(parser));
+    parser.scratch = scratch;
+    parser.options = &sax_options;
+    parser.sax = sax;
+    parser.types = types;
+    size_t capacity = JSON_DEPTH_MAX_LIMIT;
+    if (options != NULL && options->stack != NULL) {
+        // A frame is way more than the byte the level takes here
+        parser.types = (uint8_t *) options->stack;
+        capacity = options->stack_capacity;
+    }
+
+    return json_parse_events(source, &json_sax_events, &parser, capacity);
+}
+
+static int json_is_value_delimiter(char c)
+{
+    return json_isspace(c) || c == ',' || c == ':' || c == ']' || c == '}';
+}
+
+TZOZENDEF Json_Result json_skip_value(Tzozen_Str source)
+{
+    source = tzozen_str_trim_begin(source);
+
+    if (source.len == 0) {
+        return result_failure(source, "EOF");
+    }
+
+    const char *data = source.data;
+    size_t depth = 0;
+    size_t i = 0;
+
+    do {
+        char c = data[i];
+        if (c == '"') {
+            i += 1;
+            for (;;) {
+                if (i < source.len) {
+                    i += json_string_scan(data + i, source.len - i);
+                }
+                if (i >= source.len) {
+                    return result_failure(tzozen_str_drop(source, source.len), "Expected '\"'");
+                }
+                if (data[i] == '"') break;
+                // Skip the escaped character or the control character
+                i += data[i] == '\\' ? 2 : 1;
+            }
+            i += 1;
+        } else if (c == '[' || c == '{') {
+            depth += 1;
+            i += 1;
+        } else if (c == ']' || c == '}') {
+            if (depth == 0) {
+                return result_failure(tzozen_str_drop(source, i), "Expected a value");
+            }
+            depth -= 1;
+            i += 1;
+        } else if (depth == 0) {
+            // A scalar at the top
+            while (i < source.len && !json_is_value_delimiter(data[i])) i++;
+            if (i == 0) {
+                return result_failure(source, "Expected a value");
+            }
+        } else {
+            i += 1;
+        }
+    } while (depth > 0 && i < source.len);
+
+    if (depth > 0) {
+        return result_failure(tzozen_str_drop(source, source.len), "EOF");
+    }
+
+    return result_success(tzozen_str_drop(source, i), json_string(tzozen_str_take(source, i)));
+}
+
+TZOZENDEF int json_literal_equal(Tzozen_Str literal, Tzozen_Str string)
+{
+    while (literal.len > 0) {
+        size_t n = 0;
+        while (n < literal.len && literal.data[n] != '\\') n++;
+
+        if (n > string.len || memcmp(literal.data, string.data, n) != 0) {
+            return 0;
+        }
+        tzozen_str_chop(&literal, n);
+        tzozen_str_chop(&string, n);
+
+        if (literal.len > 0) {
+            uint8_t escape_buffer[UTF8_CHUNK_CAPACITY];
+            Tzozen_Memory escape_memory = tzozen_memory(escape_buffer, sizeof(escape_buffer));
+            Json_Result result = parse_escape_sequence(&escape_memory, literal);
+            if (result.is_error) {
+                return 0;
+            }
+
+            Tzozen_Str decoded = result.value.string;
+            if (decoded.len > string.len || memcmp(decoded.data, string.data, decoded.len) != 0) {
+                return 0;
+            }
+            tzozen_str_chop(&string, decoded.len);
+            literal = result.rest;
+        }
+    }
+
+    return string.len == 0;
+}
+
+TZOZENDEF int json_cursor_enter(Json_Cursor *cursor, Tzozen_Str value)
+{
+    memset(cursor, 0, sizeof(*cursor));
+    value = tzozen_str_trim_begin(value);
+
+    if (value.len == 0 || (*value.data != '[' && *value.data != '{')) {
+        cursor->source = value;
+        cursor->message = "Expected '[' or '{'";
+        return -1;
+    }
+
+    cursor->close = *value.data == '[' ? ']' : '}';
+    cursor->source = tzozen_str_drop(value, 1);
+    return 0;
+}
+
+static int json_cursor_fail(Json_Cursor *cursor, Tzozen_Str source, const char *message)
+{
+    cursor->source = source;
+    cursor->message = message;
+    return -1;
+}
+
+// Moves the cursor to the beginning of the next element and returns 1
+// and its key and the source starting at its value, 0 at the end of the
+// container, -1 on errors. The caller consumes the value itself.
+static int json_cursor_advance(Json_Cursor *cursor, Tzozen_Str *key, Tzozen_Str *value_source)
+{
+    if (cursor->done) {
+        return 0;
+    }
+
+    const char *expected_close_or_comma = cursor->close == ']'
+        ? "Expected ']' or ','"
+        : "Expected '}' or ','";
+
+    Tzozen_Str source = tzozen_str_trim_begin(cursor->source);
+
+    if (source.len == 0) {
+        return json_cursor_fail(cursor, source, cursor->count > 0 ? expected_close_or_comma : "EOF");
+    }
+
+    if (*source.data == cursor->close) {
+        cursor->source = tzozen_str_drop(source, 1);
+        cursor->done = 1;
+        return 0;
+    }
+
+    if (cursor->count > 0) {
+        if (*source.data != ',') {
+            return json_cursor_fail(cursor, source, expected_close_or_comma);
+        }
+        source = tzozen_str_trim_begin(tzozen_str_drop(source, 1));
+    }
+
+    Tzozen_Str key_literal = {0, NULL};
+    if (cursor->close == '}') {
+        Json_Result key_result = parse_json_string_literal(source);
+        if (key_result.is_error) {
+            return json_cursor_fail(cursor, key_result.rest, key_result.message);
+        }
+        key_literal = key_result.value.string;
+
+        source = tzozen_str_trim_begin(key_result.rest);
+        if (source.len == 0 || *source.data != ':') {
+            return json_cursor_fail(cursor, source, "Expected ':'");
+        }
+        tzozen_str_chop(&source, 1);
+    }
+
+    *key = key_literal;
+    *value_source = source;
+    return 1;
+}
+
+// Moves the cursor past the value that json_cursor_advance() stopped at
+static int json_cursor_consume(Json_Cursor *cursor, Json_Result value_result)
+{
+    if (value_result.is_error) {
+        return json_cursor_fail(cursor, value_result.rest, value_result.message);
+    }
+
+    cursor->source = value_result.rest;
+    cursor->count += 1;
+    return 1;
+}
+
+TZOZENDEF int json_cursor_next(Json_Cursor *cursor, Tzozen_Str *key, Tzozen_Str *value)
+{
+    Tzozen_Str key_literal;
+    Tzozen_Str source;
+    int status = json_cursor_advance(cursor, &key_literal, &source);
+    if (status <= 0) {
+        return status;
+    }
+
+    Json_Result value_result = json_skip_value(source);
+    if (json_cursor_consume(cursor, value_result) < 0) {
+        return -1;
+    }
+
+    if (key) *key = key_literal;
+    if (value) *value = value_result.value.string;
+    return 1;
+}
+
+TZOZENDEF int json_cursor_find(Json_Cursor *cursor, Tzozen_Str key, Tzozen_Str *value)
+{
+    assert(cursor->close == '}');
+
+    Tzozen_Str member_key;
+    Tzozen_Str member_value;
+    int status;
+    while ((status = json_cursor_next(cursor, &member_key, &member_value)) > 0) {
+        if (json_literal_equal(member_key, key)) {
+            if (value) *value = member_value;
+            return 1;
+        }
+    }
+
+    return status;
+}
+
+static int json_path_split(Tzozen_Memory *memory, Json_Path *path)
+{
+    Tzozen_Str rest = path->path;
+    char separator = '.';
+    if (rest.len > 0 && *rest.data == '/') {
+        separator = '/';
+        tzozen_str_chop(&rest, 1);
+    } else if (rest.len == 0) {
+        path->segments = NULL;
+        path->segments_count = 0;
+        return 0;
+    }
+
+    size_t count = 1;
+    for (size_t i = 0; i < rest.len; ++i) {
+        if (rest.data[i] == separator) count += 1;
+    }
+
+    Tzozen_Str *segments = TZOZEN_ALLOC(memory, Tzozen_Str, count);
+    if (segments == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t n = 0;
+        while (n < rest.len && rest.data[n] != separator) n++;
+        Tzozen_Str segment = tzozen_str_take(rest, n);
+        tzozen_str_chop(&rest, n < rest.len ? n + 1 : n);
+
+        // JSON Pointer escapes ~0 and ~1
+        if (separator == '/' && memchr(segment.data, '~', segment.len) != NULL) {
+            char *unescaped = (char *) memory_alloc(memory, segment.len);
+            if (unescaped == NULL) {
+                return -1;
+            }
+            size_t len = 0;
+            for (size_t j = 0; j < segment.len; ++j) {
+                if (segment.data[j] == '~' && j + 1 < segment.len
+                    && (segment.data[j + 1] == '0' || segment.data[j + 1] == '1')) {
+                    unescaped[len++] = segment.data[j + 1] == '0' ? '~' : '/';
+                    j += 1;
+                } else {
+                    unescaped[len++] = segment.data[j];
+                }
+            }
+            segment.data = unescaped;
+            segment.len = len;
+        }
+
+        if (tzozen_str_equal(segment, TSTR("*"))) {
+            path->wildcard = 1;
+        }
+        segments[i] = segment;
+    }
+
+    path->segments = segments;
+    path->segments_count = count;
+    return 0;
+}
+
+static int json_path_index_equal(Tzozen_Str segment, size_t index)
+{
+    if (segment.len == 0 || segment.len > 19) {
+        return 0;
+    }
+
+    size_t value = 0;
+    for (size_t i = 0; i < segment.len; ++i) {
+        if (!json_isdigit(segment.data[i])) return 0;
+        value = value * 10 + (size_t) (segment.data[i] - '0');
+    }
+    return value == index;
+}
+
+// Materializes the value that ends the paths that are `depth` segments
+// deep. `result` is the slice of the value from json_skip_value().
+static Json_Result json_project_finish(Tzozen_Memory *memory, Json_Result result, size_t depth,
+                                       Json_Path *paths, size_t paths_count,
+                                       const Json_Options *options)
+{
+    Tzozen_Str value = result.value.string;
+    Json_Result value_result = parse_json_value_with_options(memory, value, options);
+    if (value_result.is_error) {
+        return value_result;
+    }
+
+    for (size_t i = 0; i < paths_count; ++i) {
+        Json_Path *path = &paths[i];
+        if (path->matched != depth || path->segments_count != depth) continue;
+
+        if (path->wildcard) {
+            if (json_array_push(memory, &path->value.array, value_result.value) < 0) {
+                return result_failure(value, "Out of memory");
+            }
+        } else {
+            path->value = value_result.value;
+        }
+        path->found = 1;
+    }
+
+    return result;
+}
+
+// Handles the value at the beginning of the source that is `depth`
+// segments deep into the paths that are still matching
+static Json_Result json_project(Tzozen_Memory *memory, Tzozen_Str source, size_t depth,
+                                Json_Path *paths, size_t paths_count,
+                                const Json_Options *options)
+{
+    int ends_here = 0;
+    int goes_deeper = 0;
+    for (size_t i = 0; i < paths_count; ++i) {
+        if (paths[i].matched != depth) continue;
+        if (paths[i].segments_count == depth) {
+            ends_here = 1;
+        } else {
+            goes_deeper = 1;
+        }
+    }
+
+    Json_Cursor cursor;
+    source = tzozen_str_trim_begin(source);
+    if (!goes_deeper || json_cursor_enter(&cursor, source) < 0) {
+        // Nothing to look for inside of the value
+        Json_Result result = json_skip_value(source);
+        if (result.is_error || !ends_here) {
+            return result;
+        }
+        return json_project_finish(memory, result, depth, paths, paths_count, options);
+    }
+
+    Tzozen_Str key;
+    Tzozen_Str elem;
+    int status;
+    size_t index = 0;
+
+    // Every element is consumed once: either by the recursion when it
+    // matches or by json_skip_value() when it does not
+    while ((status = json_cursor_advance(&cursor, &key, &elem)) > 0) {
+        int matches = 0;
+        for (size_t i = 0; i < paths_count; ++i) {
+            Json_Path *path = &paths[i];
+            if (path->matched != depth || path->segments_count == depth) continue;
+
+            Tzozen_Str segment = path->segments[depth];
+            if (tzozen_str_equal(segment, TSTR("*"))
+                || (cursor.close == ']'
+                    ? json_path_index_equal(segment, index)
+                    : json_literal_equal(key, segment))) {
+                path->matched = depth + 1;
+                matches = 1;
+            }
+        }
+
+        Json_Result elem_result;
+        if (matches) {
+            elem_result = json_project(memory, elem, depth + 1, paths, paths_count, options);
+            for (size_t i = 0; i < paths_count; ++i) {
+                if (paths[i].matched == depth + 1) paths[i].matched = depth;
+            }
+            if (elem_result.is_error) {
+                return elem_result;
+            }
+        } else {
+            elem_result = json_skip_value(elem);
+        }
+
+        if (json_cursor_consume(&cursor, elem_result) < 0) {
+            break;
+        }
+        index += 1;
+    }
+
+    if (cursor.message != NULL) {
+        return result_failure(cursor.source, cursor.message);
+    }
+
+    // The cursor stopped right after the closing bracket
+    Tzozen_Str value = tzozen_str_take(source, (size_t) (cursor.source.data - source.data));
+    Json_Result result = result_success(cursor.source, json_string(value));
+    if (!ends_here) {
+        return result;
+    }
+    return json_project_finish(memory, result, depth, paths, paths_count, options);
+}
+
+
+TZOZENDEF Json_Result parse_json_paths(Tzozen_Memory *memory, Tzozen_Str source, Json_Path *paths, size_t paths_count, const Json_Options *options)
+{
+    assert(memory);
+
+    Json_Options default_options;
+    if (options == NULL) {
+        memset(&default_options, 0, sizeof(default_options));
+        options = &default_options;
+    }
+
+    Json_Parse_Mark mark = json_parse_save(memory, options);
+
+    for (size_t i = 0; i < paths_count; ++i) {
+        Json_Path *path = &paths[i];
+        path->found = 0;
+        path->wildcard = 0;
+        path->matched = 0;
+        if (json_path_split(memory, path) < 0) {
+            tzozen_memory_rollback(memory, mark.memory);
+            return result_failure(source, "Out of memory");
+        }
+        path->value = path->wildcard ? json_array_empty() : json_null();
+    }
+
+    Json_Result result = json_project(memory, source, 0, paths, paths_count, options);
+    if (result.is_error) {
+        json_parse_rollback(memory, options, mark);
+    }
+
+    return result;
+}
+
+TZOZENDEF size_t json_lines_split(Tzozen_Str source, Tzozen_Str *chunks, size_t count)
+{
+    assert(count > 0);
+
+    size_t chunk_size = source.len / count + 1;
+    size_t n = 0;
+
+    while (source.len > 0 && n < count) {
+        size_t len = source.len;
+        if (n + 1 < count && chunk_size < source.len) {
+            const char *newline = (const char *) memchr(source.data + chunk_size, '\n', source.len - chunk_size);
+            if (newline != NULL) {
+                len = (size_t) (newline - source.data) + 1;
+            }
+        }
+
+        chunks[n++] = tzozen_str_take(source, len);
+        tzozen_str_chop(&source, len);
+    }
+
+    return n;
+}
+
+TZOZENDEF size_t parse_json_lines(Tzozen_Memory *memory, Tzozen_Str *source, const Json_Options *options, Json_Line *lines, size_t capacity)
+{
+    Json_Options default_options;
+    if (options == NULL) {
+        memset(&default_options, 0, sizeof(default_options));
+        options = &default_options;
+    }
+    size_t n = 0;
+    while (source->len > 0 && n < capacity) {
+        const char *newline = (const char *) memchr(source->data, '\n', source->len);
+        size_t len = newline != NULL ? (size_t) (newline - source->data) : source->len;
+        Tzozen_Str line = tzozen_str_take(*source, len);
+        tzozen_str_chop(source, newline != NULL ? len + 1 : len);
+
+        if (tzozen_str_trim_begin(line).len == 0) {
+            continue;
+        }
+
+        Json_Parse_Mark mark = json_parse_save(memory, options);
+        Json_Result result = parse_json_value_with_options(memory, line, options);
+        if (!result.is_error) {
+            Tzozen_Str rest = tzozen_str_trim_begin(result.rest);
+            if (rest.len > 0) {
+                result = result_failure(rest, "Unexpected data after the value");
+                json_parse_rollback(memory, options, mark);
+            }
+        }
+
+        lines[n].line = line;
+        lines[n].result = result;
+        n += 1;
+    }
+
+    return n;
+}
+
+TZOZENDEF Json_Result json_array_split(Tzozen_Str source, Tzozen_Str *slices, size_t count, size_t *slices_count)
+{
+    assert(count > 0);
+    assert(slices_count);
+
+    *slices_count = 0;
+    source = tzozen_str_trim_begin(source);
+
+    if (source.len == 0 || *source.data != '[') {
+        return result_failure(source, "Expected '['");
+    }
+
+    const char *data = source.data;
+    size_t slice_size = source.len / count + 1;
+    size_t slice_begin = 1;
+    size_t depth = 0;
+    uint64_t escaped_carry = 0;
+    uint64_t in_string_carry = 0;
+
+    for (size_t offset = 0; offset < source.len; offset += 64) {
+        const char *block = data + offset;
+
+        char tail[64];
+        if (source.len - offset < 64) {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, block, source.len - offset);
+            block = tail;
+        }
+
+        Json_Block_Masks masks = json_classify_block(block);
+        uint64_t quotes = masks.quote & ~json_block_escaped(masks.backslash, &escaped_carry);
+        uint64_t in_string = json_prefix_xor(quotes) ^ in_string_carry;
+        in_string_carry = (uint64_t) 0 - (in_string >> 63);
+
+        for (uint64_t structural = masks.structural & ~in_string; structural; structural &= structural - 1) {
+            size_t i = offset + (size_t) json_ctz64(structural);
+
+            switch (data[i]) {
+            case '[':
+            case '{':
+                depth += 1;
+                break;
+            case ']':
+            case '}': {
+                depth -= 1;
+                if (depth > 0) break;
+
+                if (data[i] != ']') {
+                    return result_failure(tzozen_str_drop(source, i), "Expected ']' or ','");
+                }
+
+                Tzozen_Str slice = {i - slice_begin, data + slice_begin};
+                if (tzozen_str_trim_begin(slice).len > 0) {
+                    slices[(*slices_count)++] = slice;
+                } else if (*slices_count > 0) {
+                    // Trailing comma
+                    return result_failure(tzozen_str_drop(source, i), "Expected value after ','");
+                }
+
+                return result_success(tzozen_str_drop(source, i + 1), json_null());
+            }
+            case ',':
+                if (depth == 1 && i - slice_begin >= slice_size && *slices_count + 1 < count) {
+                    Tzozen_Str slice = {i - slice_begin, data + slice_begin};
+                    slices[(*slices_count)++] = slice;
+                    slice_begin = i + 1;
+                }
+                break;
+            }
+        }
+    }
+
+    return result_failure(tzozen_str_drop(source, source.len), "Expected ']' or ','");
+}
+
+static Json_Result json_parse_elements(Tzozen_Memory *memory, Tzozen_Str source, const Json_Options *options)
+{
+    Json_Array array;
+    memset(&array, 0, sizeof(array));
+
+    source = tzozen_str_trim_begin(source);
+
+    while (source.len > 0) {
+        // The elements are one level deep in the array
+        Json_Result item_result = parse_json_value_with_depth_and_options(memory, source, 1, options);
+        if (item_result.is_error) {
+            return item_result;
+        }
+
+        if (json_array_push(memory, &array, item_result.value) < 0) {
+            return result_failure(source, "Out of memory");
+        }
+
+        source = tzozen_str_trim_begin(item_result.rest);
+
+        if (source.len == 0) {
+            break;
+        }
+
+        if (*source.data != ',') {
+            return result_failure(source, "Expected ']' or ','");
+        }
+
+        source = tzozen_str_trim_begin(tzozen_str_drop(source, 1));
+
+        if (source.len == 0) {
+            return result_failure(source, "Expected value after ','");
+        }
+    }
+
+    if (options->finalize_containers && json_array_finalize(memory, &array) < 0) {
+        return result_failure(source, "Out of memory");
+    }
+
+    return result_success(source, json_array(array));
+}
+
+TZOZENDEF Json_Result parse_json_elements(Tzozen_Memory *memory, Tzozen_Str source, const Json_Options *options)
+{
+    Json_Options default_options;
+    if (options == NULL) {
+        memset(&default_options, 0, sizeof(default_options));
+        options = &default_options;
+    }
+    Json_Parse_Mark mark = json_parse_save(memory, options);
+    Json_Result result = json_parse_elements(memory, source, options);
+    if (result.is_error) {
+        json_parse_rollback(memory, options, mark);
+    }
+
+    return result;
+}
+
+TZOZENDEF void json_array_concat(Json_Array *array, Json_Array tail)
+{
+    if (tail.begin == NULL) {
+        return;
+    }
+
+    if (array->begin == NULL) {
+        array->begin = tail.begin;
+    } else {
+        array->end->next = tail.begin;
+    }
+
+    array->end = tail.end;
+    array->size += tail.size;
+    array->elems = NULL;
+}
+
+static uint64_t json_tape_word(Json_Tape_Tag tag, uint64_t payload)
+{
+    assert(payload <= JSON_TAPE_PAYLOAD_MASK);
+    return ((uint64_t) tag << 56) | payload;
+}
+
+static int json_tape_push(Tzozen_Memory *tape_memory, Json_Tape *tape, uint64_t word)
+{
+    uint64_t *words = (uint64_t *) memory_extend(tape_memory, tape->words, sizeof(uint64_t));
+    if (words == NULL) {
+        return -1;
+    }
+    tape->words = words;
+    tape->words[tape->size++] = word;
+    return 0;
+}
+
+static int json_tape_push_span(Tzozen_Memory *tape_memory, Json_Tape *tape,
+                               Json_Tape_Tag tag, Tzozen_Str span)
+{
+    if (json_tape_push(tape_memory, tape, json_tape_word(tag, span.len)) < 0) {
+        return -1;
+    }
+    return json_tape_push(tape_memory, tape, (uint64_t) (uintptr_t) span.data);
+}
+
+static Json_Result json_tape_parse_value(Tzozen_Memory *memory, Tzozen_Memory *tape_memory,
+                                         Tzozen_Str source, int level,
+                                         const Json_Options *options, Json_Tape *tape);
+
+static Json_Result json_tape_parse_container(Tzozen_Memory *memory, Tzozen_Memory *tape_memory,
+                                             Tzozen_Str source, int level,
+                                             const Json_Options *options, Json_Tape *tape)
+{
+    assert(source.len > 0);
+    const int is_object = *source.data == '{';
+    const char close = is_object ? '}' : ']';
+    const char *expected_close = is_object ? "Expected '}'" : "Expected ']'";
+    const char *expected_close_or_comma = is_object ? "Expected '}' or ','" : "Expected ']' or ','";
+
+    size_t begin = tape->size;
+    if (json_tape_push(tape_memory, tape, 0) < 0) {
+        return result_failure(source, "Out of memory");
+    }
+
+    tzozen_str_chop(&source, 1);
+    source = tzozen_str_trim_begin(source);
+
+    if (source.len == 0) {
+        return result_failure(source, expected_close);
+    }
+
+    if (*source.data != close) {
+        for (;;) {
+            if (is_object) {
+                Json_Result key_result = json_parse_interned_string(memory, source, options, 1);
+                if (key_result.is_error) {
+                    return key_result;
+                }
+                if (json_tape_push_span(tape_memory, tape, JSON_TAPE_STRING, key_result.value.string) < 0) {
+                    return result_failure(source, "Out of memory");
+                }
+                source = tzozen_str_trim_begin(key_result.rest);
+
+                if (source.len == 0 || *source.data != ':') {
+                    return result_failure(source, "Expected ':'");
+                }
+                tzozen_str_chop(&source, 1);
+            }
+
+            Json_Result item_result = json_tape_parse_value(memory, tape_memory, source, level + 1, options, tape);
+            if (item_result.is_error) {
+                return item_result;
+            }
+            source = tzozen_str_trim_begin(item_result.rest);
+
+            if (source.len == 0) {
+                return result_failure(source, expected_close_or_comma);
+            }
+
+            if (*source.data == close) {
+                break;
+            }
+
+            if (*source.data != ',') {
+                return result_failure(source, expected_close_or_comma);
+            }
+
+            source = tzozen_str_trim_begin(tzozen_str_drop(source, 1));
+        }
+    }
+
+    Json_Tape_Tag begin_tag = is_object ? JSON_TAPE_OBJECT_BEGIN : JSON_TAPE_ARRAY_BEGIN;
+    Json_Tape_Tag end_tag = is_object ? JSON_TAPE_OBJECT_END : JSON_TAPE_ARRAY_END;
+    if (json_tape_push(tape_memory, tape, json_tape_word(end_tag, begin)) < 0) {
+        return result_failure(source, "Out of memory");
+    }
+    tape->words[begin] = json_tape_word(begin_tag, tape->size);
+
+    Json_Result result = result_success(tzozen_str_drop(source, 1), json_null());
+    return result;
+}
+
+static Json_Result json_tape_parse_value(Tzozen_Memory *memory, Tzozen_Memory *tape_memory,
+                                         Tzozen_Str source, int level,
+                                         const Json_Options *options, Json_Tape *tape)
+{
+    if (level >= JSON_DEPTH_MAX_LIMIT) {
+        return result_failure(source, "Reached the max limit of depth");
+    }
+
+    source = tzozen_str_trim_begin(source);
+
+    if (source.len == 0) {
+        return result_failure(source, "EOF");
+    }
+
+    Json_Result result;
+    uint64_t word = 0;
+
+    switch (*source.data) {
+    case 'n':
+        result = parse_token(source, TSTR("null"), json_null(), "Expected `null`");
+        word = json_tape_word(JSON_TAPE_NULL, 0);
+        break;
+    case 't':
+        result = parse_token(source, TSTR("true"), json_true(), "Expected `true`");
+        word = json_tape_word(JSON_TAPE_TRUE, 0);
+        break;
+    case 'f':
+        result = parse_token(source, TSTR("false"), json_false(), "Expected `false`");
+        word = json_tape_word(JSON_TAPE_FALSE, 0);
+        break;
+    case '"':
+        result = json_parse_interned_string(memory, source, options, 0);
+        if (result.is_error) return result;
+        if (json_tape_push_span(tape_memory, tape, JSON_TAPE_STRING, result.value.string) < 0) {
+            return result_failure(source, "Out of memory");
+        }
+        return result;
+    case '[':
+    case '{':
+        return json_tape_parse_container(memory, tape_memory, source, level, options, tape);
+    default: {
+        // The tape keeps the whole number literal, so it is validated
+        // in place and then cloned in one piece.
+        Json_Options borrow = *options;
+        borrow.borrow_source = 1;
+        result = parse_json_number_with_options(memory, source, &borrow);
+        if (result.is_error) return result;
+
+        Tzozen_Str literal = {(size_t) (result.rest.data - source.data), source.data};
+        if (!options->borrow_source && tzozen_str_clone(memory, literal, &literal) < 0) {
+            return result_failure(source, "Out of memory");
+        }
+        if (json_tape_push_span(tape_memory, tape, JSON_TAPE_NUMBER, literal) < 0) {
+            return result_failure(source, "Out of memory");
+        }
+        return result;
+    }
+    }
+
+    if (result.is_error) return result;
+    if (json_tape_push(tape_memory, tape, word) < 0) {
+        return result_failure(source, "Out of memory");
+    }
+    return result;
+}
+
+TZOZENDEF Json_Result parse_json_tape(Tzozen_Memory *memory, Tzozen_Memory *tape_memory,
+                                      Tzozen_Str source, const Json_Options *options,
+                                      Json_Tape *tape)
+{
+    assert(tape_memory);
+    assert(tape);
+
+    Json_Parse_Mark mark = json_parse_save(memory, options);
+    Tzozen_Memory_Mark tape_mark = tzozen_memory_save(tape_memory);
+
+    tape->words = TZOZEN_ALLOC(tape_memory, uint64_t, 0);
+    tape->size = 0;
+    if (tape->words == NULL) {
+        return result_failure(source, "Out of memory");
+    }
+
+    Json_Result result = json_tape_parse_value(memory, tape_memory, source, 0, options, tape);
+    if (result.is_error) {
+        json_parse_rollback(memory, options, mark);
+        tzozen_memory_rollback(tape_memory, tape_mark);
+    }
+
+    return result;
+}
+
+TZOZENDEF Json_Tape_Tag json_tape_tag(Json_Tape tape, size_t i)
+{
+    assert(i < tape.size);
+    return (Json_Tape_Tag) (tape.words[i] >> 56);
+}
+
+TZOZENDEF Json_Type json_tape_type(Json_Tape tape, size_t i)
+{
+    switch (json_tape_tag(tape, i)) {
+    case JSON_TAPE_NULL: return JSON_NULL;
+    case JSON_TAPE_TRUE:
+    case JSON_TAPE_FALSE: return JSON_BOOLEAN;
+    case JSON_TAPE_NUMBER: return JSON_NUMBER;
+    case JSON_TAPE_STRING: return JSON_STRING;
+    case JSON_TAPE_ARRAY_BEGIN: return JSON_ARRAY;
+    case JSON_TAPE_OBJECT_BEGIN: return JSON_OBJECT;
+    case JSON_TAPE_ARRAY_END:
+    case JSON_TAPE_OBJECT_END:
+        break;
+    }
+
+    assert(0 && "Not a value on the tape");
+    return JSON_NULL;
+}
+
+TZOZENDEF size_t json_tape_skip(Json_Tape tape, size_t i)
+{
+    switch (json_tape_tag(tape, i)) {
+    case JSON_TAPE_ARRAY_BEGIN:
+    case JSON_TAPE_OBJECT_BEGIN:
+        return (size_t) (tape.words[i] & JSON_TAPE_PAYLOAD_MASK);
+    case JSON_TAPE_NUMBER:
+    case JSON_TAPE_STRING:
+        return i + 2;
+    default:
+        return i + 1;
+    }
+}
+
+TZOZENDEF size_t json_tape_next_elem(Json_Tape tape, size_t container, size_t elem)
+{
+    if (json_tape_tag(tape, container) == JSON_TAPE_OBJECT_BEGIN) {
+        return json_tape_skip(tape, json_tape_object_value(tape, elem));
+    }
+    return json_tape_skip(tape, elem);
+}
+
+TZOZENDEF int json_tape_is_end(Json_Tape tape, size_t i)
+{
+    Json_Tape_Tag tag = json_tape_tag(tape, i);
+    return tag == JSON_TAPE_ARRAY_END || tag == JSON_TAPE_OBJECT_END;
+}
+
+TZOZENDEF int json_tape_boolean(Json_Tape tape, size_t i)
+{
+    assert(json_tape_type(tape, i) == JSON_BOOLEAN);
+    return json_tape_tag(tape, i) == JSON_TAPE_TRUE;
+}
+
+TZOZENDEF Tzozen_Str json_tape_string(Json_Tape tape, size_t i)
+{
+    assert(json_tape_tag(tape, i) == JSON_TAPE_STRING);
+    Tzozen_Str result = {
+        (size_t) (tape.words[i] & JSON_TAPE_PAYLOAD_MASK),
+        (const char *) (uintptr_t) tape.words[i + 1]
+    };
+    return result;
+}
+
+TZOZENDEF Json_Number json_tape_number(Json_Tape tape, size_t i)
+{
+    assert(json_tape_tag(tape, i) == JSON_TAPE_NUMBER);
+    Tzozen_Str literal = {
+        (size_t) (tape.words[i] & JSON_TAPE_PAYLOAD_MASK),
+        (const char *) (uintptr_t) tape.words[i + 1]
+    };
+
+    Json_Number number;
+    memset(&number, 0, sizeof(number));
+
+    size_t n = 0;
+    while (n < literal.len && literal.data[n] != '.' && literal.data[n] != 'e' && literal.data[n] != 'E') n++;
+    number.integer = tzozen_str_take(literal, n);
+    literal = tzozen_str_drop(literal, n);
+
+    number.fraction.data = literal.data;
+    if (literal.len && *literal.data == '.') {
+        tzozen_str_chop(&literal, 1);
+        n = 0;
+        while (n < literal.len && literal.data[n] != 'e' && literal.data[n] != 'E') n++;
+        number.fraction = tzozen_str_take(literal, n);
+        literal = tzozen_str_drop(literal, n);
+    }
+
+    number.exponent = tzozen_str_drop(literal, literal.len ? 1 : 0);
+
+    return number;
+}
+
+TZOZENDEF size_t json_tape_object_value(Json_Tape tape, size_t key)
+{
+    assert(json_tape_tag(tape, key) == JSON_TAPE_STRING);
+    return key + 2;
+}
+
+TZOZENDEF Json_Type json_cell_type(const Json_Cell *cell)
+{
+    switch ((Json_Cell_Tag) cell->tag) {
+    case JSON_CELL_NULL: return JSON_NULL;
+    case JSON_CELL_FALSE:
+    case JSON_CELL_TRUE: return JSON_BOOLEAN;
+    case JSON_CELL_INTEGER:
+    case JSON_CELL_NUMBER: return JSON_NUMBER;
+    case JSON_CELL_SMALL_STRING:
+    case JSON_CELL_STRING: return JSON_STRING;
+    case JSON_CELL_ARRAY: return JSON_ARRAY;
+    case JSON_CELL_OBJECT: return JSON_OBJECT;
+    }
+
+    assert(0 && "Unknown cell tag");
+    return JSON_NULL;
+}
+
+TZOZENDEF int json_cell_boolean(const Json_Cell *cell)
+{
+    assert(cell->tag == JSON_CELL_TRUE || cell->tag == JSON_CELL_FALSE);
+    return cell->tag == JSON_CELL_TRUE;
+}
+
+TZOZENDEF Tzozen_Str json_cell_string(const Json_Cell *cell)
+{
+    if (cell->tag == JSON_CELL_SMALL_STRING) {
+        Tzozen_Str s = {cell->small_len, (const char *) cell + 2};
+        return s;
+    }
+
+    assert(cell->tag == JSON_CELL_STRING);
+    Tzozen_Str s = {cell->size, cell->as.string};
+    return s;
+}
+
+TZOZENDEF int json_cell_integer(const Json_Cell *cell, int64_t *integer)
+{
+    if (cell->tag != JSON_CELL_INTEGER) {
+        return 0;
+    }
+    *integer = cell->as.integer;
+    return 1;
+}
+
+TZOZENDEF Json_Number json_cell_number(const Json_Cell *cell)
+{
+    assert(cell->tag == JSON_CELL_NUMBER);
+    return *cell->as.number;
+}
+
+TZOZENDEF size_t json_cell_size(const Json_Cell *cell)
+{
+    assert(cell->tag == JSON_CELL_ARRAY || cell->tag == JSON_CELL_OBJECT);
+    return cell->size;
+}
+
+TZOZENDEF const Json_Cell *json_cell_at(const Json_Cell *cell, size_t i)
+{
+    assert(cell->tag == JSON_CELL_ARRAY);
+    assert(i < cell->size);
+    return &cell->as.elems[i];
+}
+
+TZOZENDEF const Json_Cell_Member *json_cell_member(const Json_Cell *cell, size_t i)
+{
+    assert(cell->tag == JSON_CELL_OBJECT);
+    assert(i < cell->size);
+    return &cell->as.members[i];
+}
+
+TZOZENDEF const Json_Cell *json_cell_find(const Json_Cell *cell, Tzozen_Str key)
+{
+    assert(cell->tag == JSON_CELL_OBJECT);
+
+    for (size_t i = cell->size; i > 0; --i) {
+        const Json_Cell_Member *member = &cell->as.members[i - 1];
+        if (tzozen_str_equal(json_cell_string(&member->key), key)) {
+            return &member->value;
+        }
+    }
+
+    return NULL;
+}
+
+static int json_is_borrowed(Tzozen_Str borrowed, Tzozen_Str string)
+{
+    return borrowed.data != NULL
+        && borrowed.data <= string.data
+        && string.data + string.len <= borrowed.data + borrowed.len;
+}
+
+static int json_string_to_cell(Tzozen_Memory *memory, Tzozen_Str string, Tzozen_Str borrowed, Json_Cell *cell)
+{
+    if (string.len <= JSON_CELL_SMALL_CAPACITY) {
+        cell->tag = JSON_CELL_SMALL_STRING;
+        cell->small_len = (uint8_t) string.len;
+        if (string.len > 0) memcpy((char *) cell + 2, string.data, string.len);
+        return 0;
+    }
+
+    if (string.len > UINT32_MAX) {
+        return -1;
+    }
+
+    if (!json_is_borrowed(borrowed, string) && tzozen_str_clone(memory, string, &string) < 0) {
+        return -1;
+    }
+
+    cell->tag = JSON_CELL_STRING;
+    cell->size = (uint32_t) string.len;
+    cell->as.string = string.data;
+    return 0;
+}
+
+// The integers are only inlined if printing them gives back the same
+// literal, so "-0" stays a record.
+static int json_cell_integer_literal(Json_Number number, int64_t *integer)
+{
+    if (number.fraction.len > 0 || number.exponent.len > 0
+        || tzozen_str_equal(number.integer, TSTR("-0"))) {
+        return 0;
+    }
+
+    return tzozen_str_stoi64_checked(number.integer, integer) == 0;
+}
+
+static int json_number_to_cell(Tzozen_Memory *memory, Json_Number number, Tzozen_Str borrowed, Json_Cell *cell)
+{
+    int64_t integer = 0;
+    if (json_cell_integer_literal(number, &integer)) {
+        cell->tag = JSON_CELL_INTEGER;
+        cell->as.integer = integer;
+        return 0;
+    }
+
+    Json_Number *record = TZOZEN_ALLOC(memory, Json_Number, 1);
+    if (record == NULL) {
+        return -1;
+    }
+
+    if (json_is_borrowed(borrowed, number.integer)
+        && json_is_borrowed(borrowed, number.fraction)
+        && json_is_borrowed(borrowed, number.exponent)) {
+        *record = number;
+    } else {
+        // All three parts in a single allocation, like parse_json_number_with_options() does
+        size_t len = number.integer.len + number.fraction.len + number.exponent.len;
+        char *clone = (char *) memory_alloc(memory, len);
+        if (clone == NULL) {
+            return -1;
+        }
+
+        Tzozen_Str parts[3] = {number.integer, number.fraction, number.exponent};
+        for (size_t i = 0; i < 3; ++i) {
+            if (parts[i].len > 0) memcpy(clone, parts[i].data, parts[i].len);
+            parts[i].data = clone;
+            clone += parts[i].len;
+        }
+
+        *record = json_number(parts[0], parts[1], parts[2]).number;
+    }
+
+    cell->tag = JSON_CELL_NUMBER;
+    cell->as.number = record;
+    return 0;
+}
+
+// A value that still has to be converted into its cell
+typedef struct {
+    Json_Value value;
+    Json_Cell *cell;
+} Json_Cell_Work;
+
+TZOZENDEF int json_value_to_cell(Tzozen_Memory *memory, Tzozen_Memory *scratch,
+                                 Json_Value value, Tzozen_Str borrowed, Json_Cell *cell)
+{
+    assert(memory);
+    assert(scratch);
+    assert(cell);
+
+    Tzozen_Memory_Mark mark = tzozen_memory_save(scratch);
+
+    // The containers are converted level by level through a stack of
+    // the pending values, so the depth costs nothing on the C stack.
+    Json_Cell_Work *work = TZOZEN_ALLOC(scratch, Json_Cell_Work, 1);
+    if (work == NULL) {
+        return -1;
+    }
+    work[0].value = value;
+    work[0].cell = cell;
+    size_t work_size = 1;
+
+    while (work_size > 0) {
+        // The popped item is always at the end of the scratch memory
+        Json_Cell_Work current = work[--work_size];
+        scratch->size -= sizeof(Json_Cell_Work);
+
+        Json_Cell *target = current.cell;
+        memset(target, 0, sizeof(*target));
+
+        switch (current.value.type) {
+        case JSON_NULL:
+            target->tag = JSON_CELL_NULL;
+            break;
+        case JSON_BOOLEAN:
+            target->tag = current.value.boolean ? JSON_CELL_TRUE : JSON_CELL_FALSE;
+            break;
+        case JSON_NUMBER:
+            if (json_number_to_cell(memory, current.value.number, borrowed, target) < 0) goto fail;
+            break;
+        case JSON_STRING:
+            if (json_string_to_cell(memory, current.value.string, borrowed, target) < 0) goto fail;
+            break;
+        case JSON_ARRAY:
+        case JSON_OBJECT: {
+            int is_object = current.value.type == JSON_OBJECT;
+            size_t size = is_object ? current.value.object.size : current.value.array.size;
+            if (size > UINT32_MAX) goto fail;
+
+            target->tag = is_object ? JSON_CELL_OBJECT : JSON_CELL_ARRAY;
+            target->size = (uint32_t) size;
+            if (size == 0) break;
+
+            Json_Cell *cells = (Json_Cell *) memory_alloc_aligned(
+                memory, sizeof(Json_Cell) * (is_object ? 2 : 1) * size, TZOZEN_ALIGNOF(Json_Cell));
+            if (cells == NULL) goto fail;
+
+            work = (Json_Cell_Work *) memory_extend(scratch, work, sizeof(Json_Cell_Work) * size);
+            if (work == NULL) goto fail;
+
+            if (is_object) {
+                target->as.members = (const Json_Cell_Member *) cells;
+                size_t i = 0;
+                FOR_JSON (Json_Object, elem, current.value.object) {
+                    Json_Cell_Member *member = (Json_Cell_Member *) cells + i;
+                    memset(&member->key, 0, sizeof(member->key));
+                    if (json_string_to_cell(memory, elem->key, borrowed, &member->key) < 0) goto fail;
+                    work[work_size].value = elem->value;
+                    work[work_size].cell = &member->value;
+                    work_size += 1;
+                    i += 1;
+                }
+            } else {
+                target->as.elems = cells;
+                size_t i = 0;
+                FOR_JSON (Json_Array, elem, current.value.array) {
+                    work[work_size].value = elem->value;
+                    work[work_size].cell = &cells[i++];
+                    work_size += 1;
+                }
+            }
+        } break;
+        }
+    }
+
+    tzozen_memory_rollback(scratch, mark);
+    return 0;
+
+fail:
+    tzozen_memory_rollback(scratch, mark);
+    return -1;
+}
+
+// The cells that json_parse_events() builds for parse_json_cells(). The
+// pending cells of all the open containers form a single run at the end
+// of the scratch: every open container is its own cell followed by its
+// finished elements (or by the keys and the values of its members).
+// Those are moved into the memory when the container is closed.
+typedef struct {
+    Tzozen_Memory *memory;
+    Tzozen_Memory *scratch;
+    // Only borrow_source is set. The strings and the numbers are taken
+    // from the source and json_string_to_cell() and
+    // json_number_to_cell() decide what to copy.
+    Json_Options options;
+    Tzozen_Str borrowed;
+    Json_Cell *pending;
+    size_t pending_size;
+    // The innermost open container in `pending`. Until a container is
+    // closed its `as.integer` is the index of the parent.
+    size_t open;
+    size_t depth;
+} Json_Cell_Builder;
+
+static Json_Cell *json_cell_builder_push(Json_Cell_Builder *builder)
+{
+    Json_Cell *pending = (Json_Cell *) memory_extend(builder->scratch, builder->pending, sizeof(Json_Cell));
+    if (pending == NULL) {
+        return NULL;
+    }
+    builder->pending = pending;
+
+    Json_Cell *cell = &pending[builder->pending_size++];
+    memset(cell, 0, sizeof(*cell));
+    return cell;
+}
+
+static int json_cell_builder_literal(void *data, Json_Value value)
+{
+    Json_Cell *cell = json_cell_builder_push((Json_Cell_Builder *) data);
+    if (cell == NULL) {
+        return -1;
+    }
+
+    if (value.type == JSON_NULL) {
+        cell->tag = JSON_CELL_NULL;
+    } else {
+        cell->tag = value.boolean ? JSON_CELL_TRUE : JSON_CELL_FALSE;
+    }
+    return 0;
+}
+
+// The strings with escape sequences are decoded right into the memory,
+// and given back if they fit into the cell
+static Json_Result json_cell_builder_string(void *data, Tzozen_Str source)
+{
+    Json_Cell_Builder *builder = (Json_Cell_Builder *) data;
+    Tzozen_Memory_Mark mark = tzozen_memory_save(builder->memory);
+    Json_Result result = parse_json_string_with_options(builder->memory, source, &builder->options);
+    if (result.is_error) return result;
+
+    Tzozen_Str string = result.value.string;
+    Tzozen_Str owned = json_is_borrowed(source, string) ? builder->borrowed : string;
+    Json_Cell *cell = json_cell_builder_push(builder);
+    if (cell == NULL || json_string_to_cell(builder->memory, string, owned, cell) < 0) {
+        return result_failure(source, "Out of memory");
+    }
+
+    if (cell->tag == JSON_CELL_SMALL_STRING) {
+        tzozen_memory_rollback(builder->memory, mark);
+    }
+    return result;
+}
+
+static Json_Result json_cell_builder_number(void *data, Tzozen_Str source)
+{
+    Json_Cell_Builder *builder = (Json_Cell_Builder *) data;
+    Json_Result result = parse_json_number_with_options(builder->memory, source, &builder->options);
+    if (result.is_error) return result;
+
+    Json_Cell *cell = json_cell_builder_push(builder);
+    if (cell == NULL || json_number_to_cell(builder->memory, result.value.number, builder->borrowed, cell) < 0) {
+        return result_failure(source, "Out of memory");
+    }
+    return result;
+}
+
+static int json_cell_builder_open(void *data, Json_Type type)
+{
+    Json_Cell_Builder *builder = (Json_Cell_Builder *) data;
+    Json_Cell *cell = json_cell_builder_push(builder);
+    if (cell == NULL) {
+        return -1;
+    }
+
+    cell->tag = type == JSON_ARRAY ? JSON_CELL_ARRAY : JSON_CELL_OBJECT;
+    cell->as.integer = (int64_t) builder->open;
+    builder->open = builder->pending_size - 1;
+    builder->depth += 1;
+    return 0;
+}
+
+static int json_cell_builder_close(void *data)
+{
+    Json_Cell_Builder *builder = (Json_Cell_Builder *) data;
+    Json_Cell *container = &builder->pending[builder->open];
+    size_t count = builder->pending_size - builder->open - 1;
+    size_t size = container->tag == JSON_CELL_OBJECT ? count / 2 : count;
+    if (size > UINT32_MAX) {
+        return -1;
+    }
+
+    size_t parent = (size_t) container->as.integer;
+    memset(&container->as, 0, sizeof(container->as));
+    container->size = (uint32_t) size;
+
+    if (count > 0) {
+        Json_Cell *cells = (Json_Cell *) memory_alloc_aligned(
+            builder->memory, sizeof(Json_Cell) * count, TZOZEN_ALIGNOF(Json_Cell));
+        if (cells == NULL) {
+            return -1;
+        }
+        memcpy(cells, container + 1, sizeof(Json_Cell) * count);
+
+        if (container->tag == JSON_CELL_OBJECT) {
+            container->as.members = (const Json_Cell_Member *) cells;
+        } else {
+            container->as.elems = cells;
+        }
+    }
+
+    // The pending run is always at the end of the scratch memory
+    builder->scratch->size -= sizeof(Json_Cell) * count;
+    builder->pending_size -= count;
+    builder->open = parent;
+    builder->depth -= 1;
+
+    if (builder->depth == 0) {
+        return JSON_NULL;
+    }
+    return builder->pending[parent].tag == JSON_CELL_ARRAY ? JSON_ARRAY : JSON_OBJECT;
+}
+
+static const Json_Events json_cell_builder_events = {
+    "Out of memory",
+    json_cell_builder_literal,
+    json_cell_builder_string,
+    json_cell_builder_number,
+    json_cell_builder_string,
+    json_cell_builder_open,
+    json_cell_builder_close,
+};
+
+TZOZENDEF Json_Result parse_json_cells(Tzozen_Memory *memory, Tzozen_Memory *scratch, Tzozen_Str source, const Json_Options *options, Json_Cell *cell)
+{
+    assert(memory);
+    assert(scratch);
+    assert(cell);
+
+    Json_Cell_Builder builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.memory = memory;
+    builder.scratch = scratch;
+    builder.options.borrow_source = 1;
+
+    size_t capacity = JSON_DEPTH_MAX_LIMIT;
+    if (options != NULL) {
+        if (options->borrow_source) {
+            builder.borrowed = source;
+        }
+        if (options->stack != NULL) {
+            capacity = options->stack_capacity;
+        }
+    }
+
+    Tzozen_Memory_Mark mark = tzozen_memory_save(memory);
+    Tzozen_Memory_Mark scratch_mark = tzozen_memory_save(scratch);
+
+    Json_Result result;
+    builder.pending = TZOZEN_ALLOC(scratch, Json_Cell, 0);
+    if (builder.pending == NULL) {
+        result = result_failure(source, "Out of memory");
+    } else {
+        result = json_parse_events(source, &json_cell_builder_events, &builder, capacity);
+    }
+
+    if (result.is_error) {
+        tzozen_memory_rollback(memory, mark);
+    } else {
+        assert(builder.pending_size == 1);
+        *cell = builder.pending[0];
+    }
+
+    tzozen_memory_rollback(scratch, scratch_mark);
+    return result;
+}
+
+TZOZENDEF int json_push_init(Json_Push_Parser *parser, Tzozen_Memory *memory, const Json_Options *options)
+{
+    assert(parser);
+    assert(memory);
+
+    memset(parser, 0, sizeof(*parser));
+    parser->memory = memory;
+    if (options != NULL) {
+        parser->options = *options;
+    }
+    parser->options.borrow_source = 0;
+    // The tokens are accumulated and decoded in the main memory
+    parser->options.bytes = NULL;
+
+    if (parser->options.stack != NULL) {
+        parser->stack = parser->options.stack;
+        parser->stack_capacity = parser->options.stack_capacity;
+    } else {
+        parser->stack = TZOZEN_ALLOC(memory, Json_Frame, JSON_DEPTH_MAX_LIMIT);
+        if (parser->stack == NULL) {
+            return -1;
+        }
+        parser->stack_capacity = JSON_DEPTH_MAX_LIMIT;
+    }
+
+    parser->mark = tzozen_memory_save(memory);
+
+    return 0;
+}
+
+static void json_push_fail(Json_Push_Parser *parser, const char *message)
+{
+    parser->status = JSON_PUSH_ERROR;
+    parser->message = message;
+    // The intern table may point to the new strings already
+    if (parser->options.intern == NULL) {
+        tzozen_memory_rollback(parser->memory, parser->mark);
+    }
+}
+
+// Appends the first `n` bytes of the chunk to the current token
+static void json_push_take(Json_Push_Parser *parser, Tzozen_Str *chunk, size_t n)
+{
+    if (n > 0) {
+        Tzozen_Memory *memory = parser->memory;
+        uint8_t *token = (uint8_t *) memory_extend(memory, memory->buffer + parser->token_start, n);
+        if (token == NULL) {
+            json_push_fail(parser, "Out of memory");
+            return;
+        }
+        // The token might have moved to a new block
+        parser->token_start = (size_t) (token - memory->buffer);
+        memcpy(memory->buffer + memory->size - n, chunk->data, n);
+    }
+
+    tzozen_str_chop(chunk, n);
+    parser->position += n;
+}
+
+static Tzozen_Str json_push_token(Json_Push_Parser *parser)
+{
+    Tzozen_Str token = {
+        parser->memory->size - parser->token_start,
+        (const char *) parser->memory->buffer + parser->token_start
+    };
+    return token;
+}
+
+static void json_push_value(Json_Push_Parser *parser, Json_Value value)
+{
+    if (parser->depth == 0) {
+        parser->value = value;
+        parser->state = JSON_PUSH_END;
+        parser->status = JSON_PUSH_DONE;
+        return;
+    }
+
+    Json_Frame *frame = &parser->stack[parser->depth - 1];
+    if (frame->container.type == JSON_ARRAY) {
+        if (json_array_push(parser->memory, &frame->container.array, value) < 0) {
+            json_push_fail(parser, "Out of memory");
+            return;
+        }
+    } else {
+        assert(frame->container.type == JSON_OBJECT);
+        if (json_object_push(parser->memory, &frame->container.object, frame->key, value) < 0) {
+            json_push_fail(parser, "Out of memory");
+            return;
+        }
+    }
+
+    parser->state = JSON_PUSH_AFTER_VALUE;
+}
+
+static void json_push_open(Json_Push_Parser *parser, Json_Value container, Json_Push_State state)
+{
+    assert(parser->depth < parser->stack_capacity);
+    Json_Frame *frame = &parser->stack[parser->depth++];
+    memset(frame, 0, sizeof(*frame));
+    frame->container = container;
+    parser->state = state;
+}
+
+static void json_push_close(Json_Push_Parser *parser)
+{
+    assert(parser->depth > 0);
+    Json_Frame *frame = &parser->stack[parser->depth - 1];
+    const Json_Options *options = &parser->options;
+
+    if (frame->container.type == JSON_ARRAY) {
+        if (options->finalize_containers && json_array_finalize(parser->memory, &frame->container.array) < 0) {
+            json_push_fail(parser, "Out of memory");
+            return;
+        }
+    } else {
+        if (options->finalize_containers && json_object_finalize(parser->memory, &frame->container.object) < 0) {
+            json_push_fail(parser, "Out of memory");
+            return;
+        }
+        if (options->hash_threshold > 0
+            && frame->container.object.size >= options->hash_threshold
+            && json_object_hash(parser->memory, &frame->container.object, options->hash_seed) < 0) {
+            json_push_fail(parser, "Out of memory");
+            return;
+        }
+    }
+
+    parser->depth -= 1;
+    json_push_value(parser, frame->container);
+}
+
+static void json_push_string_done(Json_Push_Parser *parser)
+{
+    Tzozen_Memory *memory = parser->memory;
+
+    // The escape-free strings stay in the raw literal and the escaped
+    // ones are decoded right after it. Either way the result is moved
+    // over the raw literal.
+    Json_Options string_options;
+    memset(&string_options, 0, sizeof(string_options));
+    string_options.borrow_source = 1;
+    uint8_t *token_buffer = memory->buffer;
+    Json_Result result = parse_json_string_with_options(memory, json_push_token(parser), &string_options);
+    if (result.is_error) {
+        json_push_fail(parser, result.message);
+        return;
+    }
+    assert(result.rest.len == 0);
+
+    Tzozen_Str string = result.value.string;
+    // The decoded string might be in a new block
+    char *dest = (char *) token_buffer + parser->token_start;
+    memmove(dest, string.data, string.len);
+    memory_restore(memory, token_buffer, parser->token_start + string.len);
+    string.data = dest;
+
+    Json_Intern *intern = parser->options.intern;
+    if (intern != NULL && (parser->token_is_key || string.len <= intern->max_value_len)) {
+        Tzozen_Str interned = json_intern(intern, string);
+        if (interned.data != string.data) {
+            memory_restore(memory, token_buffer, parser->token_start);
+            string = interned;
+        }
+    }
+
+    if (parser->token_is_key) {
+        parser->stack[parser->depth - 1].key = string;
+        parser->state = JSON_PUSH_COLON;
+    } else {
+        json_push_value(parser, json_string(string));
+    }
+}
+
+static void json_push_begin_string(Json_Push_Parser *parser, int is_key)
+{
+    Tzozen_Memory *memory = parser->memory;
+    parser->token_is_key = is_key;
+    parser->token_escape = 0;
+    parser->state = JSON_PUSH_STRING;
+
+    uint8_t *quote = (uint8_t *) memory_extend(memory, memory->buffer + memory->size, 1);
+    if (quote == NULL) {
+        json_push_fail(parser, "Out of memory");
+        return;
+    }
+    parser->token_start = (size_t) (quote - memory->buffer);
+    *quote = '"';
+}
+
+static void json_push_string_chunk(Json_Push_Parser *parser, Tzozen_Str *chunk)
+{
+    if (parser->token_escape) {
+        parser->token_escape = 0;
+        json_push_take(parser, chunk, 1);
+        return;
+    }
+
+    // Control characters are rejected later by parse_json_string_with_options()
+    size_t n = json_string_scan(chunk->data, chunk->len);
+    while (n < chunk->len && chunk->data[n] != '"' && chunk->data[n] != '\\') {
+        n += 1 + json_string_scan(chunk->data + n + 1, chunk->len - n - 1);
+    }
+
+    if (n == chunk->len) {
+        json_push_take(parser, chunk, n);
+        return;
+    }
+
+    char c = chunk->data[n];
+    json_push_take(parser, chunk, n + 1);
+    if (parser->status == JSON_PUSH_ERROR) return;
+
+    if (c == '\\') {
+        parser->token_escape = 1;
+    } else {
+        json_push_string_done(parser);
+    }
+}
+
+static int json_is_number_char(char c)
+{
+    return json_isdigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static void json_push_number_done(Json_Push_Parser *parser)
+{
+    Json_Options number_options;
+    memset(&number_options, 0, sizeof(number_options));
+    number_options.borrow_source = 1;
+    Json_Result result = parse_json_number_with_options(parser->memory, json_push_token(parser), &number_options);
+    if (result.is_error) {
+        json_push_fail(parser, result.message);
+        return;
+    }
 
-    if(source.len == 0 || *source.data != '[') {
-        return result_failure(source, "Expected '['");
+    if (result.rest.len > 0) {
+        if (parser->depth == 0) {
+            json_push_fail(parser, "Unexpected data after the value");
+        } else if (parser->stack[parser->depth - 1].container.type == JSON_ARRAY) {
+            json_push_fail(parser, "Expected ']' or ','");
+        } else {
+            json_push_fail(parser, "Expected '}' or ','");
+        }
+        return;
     }
 
-    tzozen_str_chop(&source, 1);
+    json_push_value(parser, result.value);
+}
 
-    source = tzozen_str_trim_begin(source);
+static void json_push_literal(Json_Push_Parser *parser, Tzozen_Str literal, Json_Value value, const char *message)
+{
+    parser->literal = literal;
+    parser->literal_matched = 0;
+    parser->literal_value = value;
+    parser->literal_message = message;
+    parser->state = JSON_PUSH_LITERAL;
+}
 
-    if (source.len == 0) {
-        return result_failure(source, "Expected ']'");
-    } else if(*source.data == ']') {
-        return result_success(tzozen_str_drop(source, 1), json_array_empty());
-    }
+// Handles a non-whitespace character outside of the tokens. Returns 0
+// if the character has to be handled again in the new state.
+static int json_push_structural(Json_Push_Parser *parser, char c)
+{
+    Json_Frame *frame = parser->depth > 0 ? &parser->stack[parser->depth - 1] : NULL;
 
-    Json_Array array;
-    memset(&array, 0, sizeof(array));
+    switch (parser->state) {
+    case JSON_PUSH_VALUE:
+        if (parser->depth >= parser->stack_capacity) {
+            json_push_fail(parser, "Reached the max limit of depth");
+            return 0;
+        }
 
-    while(source.len > 0) {
-        Json_Result item_result = parse_json_value_with_depth(memory, source, level + 1);
-        if(item_result.is_error) {
-            return item_result;
+        switch (c) {
+        case '[':
+            json_push_open(parser, json_array_empty(), JSON_PUSH_ARRAY_FIRST);
+            return 1;
+        case '{':
+            json_push_open(parser, json_object_empty(), JSON_PUSH_OBJECT_FIRST);
+            return 1;
+        case '"':
+            json_push_begin_string(parser, 0);
+            return 1;
+        case 'n':
+            json_push_literal(parser, TSTR("null"), json_null(), "Expected `null`");
+            return 0;
+        case 't':
+            json_push_literal(parser, TSTR("true"), json_true(), "Expected `true`");
+            return 0;
+        case 'f':
+            json_push_literal(parser, TSTR("false"), json_false(), "Expected `false`");
+            return 0;
         }
 
-        if (json_array_push(memory, &array, item_result.value) < 0) {
-            return result_failure(source, "Out of memory");
+        if (!json_is_number_char(c)) {
+            json_push_fail(parser, "Incorrect number literal");
+            return 0;
         }
+        parser->token_start = parser->memory->size;
+        parser->state = JSON_PUSH_NUMBER;
+        return 0;
 
-        source = tzozen_str_trim_begin(item_result.rest);
+    case JSON_PUSH_ARRAY_FIRST:
+        if (c == ']') {
+            json_push_close(parser);
+            return 1;
+        }
+        parser->state = JSON_PUSH_VALUE;
+        return 0;
 
-        if (source.len == 0) {
-            return result_failure(source, "Expected ']' or ','");
+    case JSON_PUSH_OBJECT_FIRST:
+        if (c == '}') {
+            json_push_close(parser);
+            return 1;
         }
+        parser->state = JSON_PUSH_KEY;
+        return 0;
 
-        if (*source.data == ']') {
-            return result_success(tzozen_str_drop(source, 1), json_array(array));
+    case JSON_PUSH_KEY:
+        if (c != '"') {
+            json_push_fail(parser, "Expected '\"'");
+            return 0;
         }
+        json_push_begin_string(parser, 1);
+        return 1;
 
-        if (*source.data != ',') {
-            return result_failure(source, "Expected ']' or ','");
+    case JSON_PUSH_COLON:
+        if (c != ':') {
+            json_push_fail(parser, "Expected ':'");
+            return 0;
+        }
+        parser->state = JSON_PUSH_VALUE;
+        return 1;
+
+    case JSON_PUSH_AFTER_VALUE:
+        assert(frame != NULL);
+        if (frame->container.type == JSON_ARRAY) {
+            if (c == ']') {
+                json_push_close(parser);
+            } else if (c == ',') {
+                parser->state = JSON_PUSH_VALUE;
+            } else {
+                json_push_fail(parser, "Expected ']' or ','");
+                return 0;
+            }
+        } else {
+            if (c == '}') {
+                json_push_close(parser);
+            } else if (c == ',') {
+                parser->state = JSON_PUSH_KEY;
+            } else {
+                json_push_fail(parser, "Expected '}' or ','");
+                return 0;
+            }
         }
+        return 1;
 
-        source = tzozen_str_trim_begin(tzozen_str_drop(source, 1));
+    case JSON_PUSH_END:
+        json_push_fail(parser, "Unexpected data after the value");
+        return 0;
+
+    case JSON_PUSH_STRING:
+    case JSON_PUSH_NUMBER:
+    case JSON_PUSH_LITERAL:
+        break;
     }
 
-    return result_failure(source, "EOF");
+    assert(0 && "Unreachable");
+    return 0;
 }
 
-TZOZENDEF Json_Result parse_json_object(Tzozen_Memory *memory, Tzozen_Str source, int level)
+TZOZENDEF Json_Push_Status json_push_feed(Json_Push_Parser *parser, Tzozen_Str chunk)
 {
-    assert(memory);
-
-    if (source.len == 0 || *source.data != '{') {
-        return result_failure(source, "Expected '{'");;
-    }
+    while (chunk.len > 0 && parser->status != JSON_PUSH_ERROR) {
+        switch (parser->state) {
+        case JSON_PUSH_STRING:
+            json_push_string_chunk(parser, &chunk);
+            break;
 
-    tzozen_str_chop(&source, 1);
+        case JSON_PUSH_NUMBER: {
+            size_t n = 0;
+            while (n < chunk.len && json_is_number_char(chunk.data[n])) n++;
+            json_push_take(parser, &chunk, n);
+            // Only the next character tells that the number is over
+            if (parser->status != JSON_PUSH_ERROR && chunk.len > 0) {
+                json_push_number_done(parser);
+            }
+        } break;
 
-    source = tzozen_str_trim_begin(source);
+        case JSON_PUSH_LITERAL:
+            if (*chunk.data != parser->literal.data[parser->literal_matched]) {
+                json_push_fail(parser, parser->literal_message);
+                break;
+            }
+            tzozen_str_chop(&chunk, 1);
+            parser->position += 1;
+            parser->literal_matched += 1;
+            if (parser->literal_matched == parser->literal.len) {
+                json_push_value(parser, parser->literal_value);
+            }
+            break;
 
-    if (source.len == 0) {
-        return result_failure(source, "Expected '}'");
-    } else if (*source.data == '}') {
-        return result_success(tzozen_str_drop(source, 1), json_object_empty());;
+        default:
+            if (json_isspace(*chunk.data) || json_push_structural(parser, *chunk.data)) {
+                tzozen_str_chop(&chunk, 1);
+                parser->position += 1;
+            }
+        }
     }
 
-    Json_Object object;
-    memset(&object, 0, sizeof(object));
-
-    while (source.len > 0) {
-        source = tzozen_str_trim_begin(source);
-
-        Json_Result key_result = parse_json_string(memory, source);
-        if (key_result.is_error) {
-            return key_result;
-        }
-        source = tzozen_str_trim_begin(key_result.rest);
+    return parser->status;
+}
 
-        if (source.len == 0 || *source.data != ':') {
-            return result_failure(source, "Expected ':'");
-        }
+TZOZENDEF Json_Push_Status json_push_finish(Json_Push_Parser *parser)
+{
+    if (parser->status == JSON_PUSH_ERROR) {
+        return parser->status;
+    }
 
-        tzozen_str_chop(&source, 1);
+    if (parser->state == JSON_PUSH_NUMBER) {
+        json_push_number_done(parser);
+    }
 
-        Json_Result value_result = parse_json_value_with_depth(memory, source, level + 1);
-        if (value_result.is_error) {
-            return value_result;
-        }
-        source = tzozen_str_trim_begin(value_result.rest);
+    if (parser->status == JSON_PUSH_NEED_MORE) {
+        json_push_fail(parser, "EOF");
+    }
 
-        assert(key_result.value.type == JSON_STRING);
-        if (json_object_push(memory, &object, key_result.value.string, value_result.value) < 0) {
-            return result_failure(source, "Out of memory");
-        }
+    return parser->status;
+}
 
-        if (source.len == 0) {
-            return result_failure(source, "Expected '}' or ','");
-        }
+TZOZENDEF Json_Sink json_sink_buffer(char *buffer, size_t capacity)
+{
+    Json_Sink sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.buffer = buffer;
+    sink.capacity = capacity;
+    return sink;
+}
 
-        if (*source.data == '}') {
-            return result_success(tzozen_str_drop(source, 1), json_object(object));
-        }
+TZOZENDEF Json_Sink json_sink_flushing(char *buffer, size_t capacity,
+                                       int (*flush)(void *data, const char *bytes, size_t size),
+                                       void *data)
+{
+    Json_Sink sink = json_sink_buffer(buffer, capacity);
+    sink.flush = flush;
+    sink.data = data;
+    return sink;
+}
 
-        if (*source.data != ',') {
-            return result_failure(source, "Expected '}' or ','");
+TZOZENDEF int json_sink_flush(Json_Sink *sink)
+{
+    if (sink->flush != NULL && !sink->error && sink->size > 0) {
+        if (sink->flush(sink->data, sink->buffer, sink->size) < 0) {
+            sink->error = 1;
         }
-
-        source = tzozen_str_drop(source, 1);
+        sink->size = 0;
     }
 
-    return result_failure(source, "EOF");
+    return sink->error ? -1 : 0;
 }
 
-TZOZENDEF Json_Result parse_json_value_with_depth(Tzozen_Memory *memory, Tzozen_Str source, int level)
+TZOZENDEF void json_sink_write(Json_Sink *sink, const char *bytes, size_t size)
 {
-    if (level >= JSON_DEPTH_MAX_LIMIT) {
-        return result_failure(source, "Reached the max limit of depth");
+    if (sink->error) {
+        return;
     }
 
-    source = tzozen_str_trim_begin(source);
+    if (size <= sink->capacity - sink->size) {
+        if (size > 0) memcpy(sink->buffer + sink->size, bytes, size);
+        sink->size += size;
+        return;
+    }
 
-    if (source.len == 0) {
-        return result_failure(source, "EOF");
+    if (sink->flush == NULL) {
+        sink->error = 1;
+        return;
     }
 
-    switch (*source.data) {
-    case 'n': return parse_token(source, TSTR("null"), json_null(), "Expected `null`");
-    case 't': return parse_token(source, TSTR("true"), json_true(), "Expected `true`");
-    case 'f': return parse_token(source, TSTR("false"), json_false(), "Expected `false`");
-    case '"': return parse_json_string(memory, source);
-    case '[': return parse_json_array(memory, source, level);
-    case '{': return parse_json_object(memory, source, level);
+    if (json_sink_flush(sink) < 0) {
+        return;
     }
 
-    return parse_json_number(memory, source);
+    // Big runs don't go through the buffer at all
+    if (size >= sink->capacity) {
+        if (sink->flush(sink->data, bytes, size) < 0) {
+            sink->error = 1;
+        }
+        return;
+    }
+
+    memcpy(sink->buffer, bytes, size);
+    sink->size = size;
 }
 
-// TODO: parse_json_value is not aware of input encoding
-TZOZENDEF Json_Result parse_json_value(Tzozen_Memory *memory, Tzozen_Str source)
+TZOZENDEF void json_sink_putc(Json_Sink *sink, char c)
 {
-    return parse_json_value_with_depth(memory, source, 0);
+    if (!sink->error && sink->size < sink->capacity) {
+        sink->buffer[sink->size++] = c;
+    } else {
+        json_sink_write(sink, &c, 1);
+    }
 }
 
-#ifndef TZOZEN_NO_STDIO
-TZOZENDEF void print_json_null(FILE *stream)
+TZOZENDEF void json_write_null(Json_Sink *sink)
 {
-    fprintf(stream, "null");
+    json_sink_write(sink, "null", 4);
 }
 
-TZOZENDEF void print_json_boolean(FILE *stream, int boolean)
+TZOZENDEF void json_write_boolean(Json_Sink *sink, int boolean)
 {
     if (boolean) {
-        fprintf(stream, "true");
+        json_sink_write(sink, "true", 4);
     } else {
-        fprintf(stream, "false");
+        json_sink_write(sink, "false", 5);
     }
 }
 
-TZOZENDEF void print_json_number(FILE *stream, Json_Number number)
+TZOZENDEF void json_write_integer(Json_Sink *sink, int64_t integer)
+{
+    char digits[20];
+    size_t n = sizeof(digits);
+    // The magnitude is taken in uint64_t so INT64_MIN does not overflow
+    uint64_t magnitude = integer < 0 ? 0 - (uint64_t) integer : (uint64_t) integer;
+
+    do {
+        digits[--n] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (integer < 0) json_sink_putc(sink, '-');
+    json_sink_write(sink, digits + n, sizeof(digits) - n);
+}
+
+TZOZENDEF void json_write_number(Json_Sink *sink, Json_Number number)
 {
-    fwrite(number.integer.data, 1, number.integer.len, stream);
+    json_sink_write(sink, number.integer.data, number.integer.len);
 
     if (number.fraction.len > 0) {
-        fputc('.', stream);
-        fwrite(number.fraction.data, 1, number.fraction.len, stream);
+        json_sink_putc(sink, '.');
+        json_sink_write(sink, number.fraction.data, number.fraction.len);
     }
 
     if (number.exponent.len > 0) {
-        fputc('e', stream);
-        fwrite(number.exponent.data, 1, number.exponent.len, stream);
+        json_sink_putc(sink, 'e');
+        json_sink_write(sink, number.exponent.data, number.exponent.len);
     }
 }
 
-TZOZENDEF void print_json_string(FILE *stream, Tzozen_Str string)
+TZOZENDEF void json_write_string(Json_Sink *sink, Tzozen_Str string)
 {
     const char *hex_digits = "0123456789abcdef";
-    const char *specials = "btnvfr";
-    const char *p = string.data;
-
-    fputc('"', stream);
-    size_t cl;
-    for (size_t i = 0; i < string.len; i++) {
-        unsigned char ch = ((unsigned char *) p)[i];
-        if (ch == '"' || ch == '\\') {
-            fwrite("\\", 1, 1, stream);
-            fwrite(p + i, 1, 1, stream);
-        } else if (ch >= '\b' && ch <= '\r') {
-            fwrite("\\", 1, 1, stream);
-            fwrite(&specials[ch - '\b'], 1, 1, stream);
-        } else if (0x20 <= ch && ch <= 0x7F) { // is printable
-            fwrite(p + i, 1, 1, stream);
-        } else if ((cl = json_get_utf8_char_len(ch)) == 1) {
-            fwrite("\\u00", 1, 4, stream);
-            fwrite(&hex_digits[(ch >> 4) % 0xf], 1, 1, stream);
-            fwrite(&hex_digits[ch % 0xf], 1, 1, stream);
-        } else {
-            fwrite(p + i, 1, cl, stream);
-            i += cl - 1;
+
+    json_sink_putc(sink, '"');
+    while (string.len > 0) {
+        // Everything except '"', '\\' and the control characters is
+        // copied as is, UTF-8 included
+        size_t n = json_string_scan(string.data, string.len);
+        json_sink_write(sink, string.data, n);
+        tzozen_str_chop(&string, n);
+        if (string.len == 0) break;
+
+        unsigned char ch = (unsigned char) *string.data;
+        tzozen_str_chop(&string, 1);
+
+        switch (ch) {
+        case '"':  json_sink_write(sink, "\\\"", 2); break;
+        case '\\': json_sink_write(sink, "\\\\", 2); break;
+        case '\b': json_sink_write(sink, "\\b", 2); break;
+        case '\f': json_sink_write(sink, "\\f", 2); break;
+        case '\n': json_sink_write(sink, "\\n", 2); break;
+        case '\r': json_sink_write(sink, "\\r", 2); break;
+        case '\t': json_sink_write(sink, "\\t", 2); break;
+        default: {
+            char escape[6] = {'\\', 'u', '0', '0', hex_digits[ch >> 4], hex_digits[ch & 0xf]};
+            json_sink_write(sink, escape, sizeof(escape));
+        } break;
         }
     }
-    fputc('"', stream);
+    json_sink_putc(sink, '"');
 }
 
-TZOZENDEF void print_json_array(FILE *stream, Json_Array array)
+TZOZENDEF void json_write_array(Json_Sink *sink, Json_Array array)
 {
-    fprintf(stream, "[");
+    json_sink_putc(sink, '[');
     int t = 0;
     FOR_JSON (Json_Array, elem, array) {
         if (t) {
-            fprintf(stream, ",");
+            json_sink_putc(sink, ',');
         } else {
             t = 1;
         }
-        print_json_value(stream, elem->value);
+        json_write_value(sink, elem->value);
     }
-    fprintf(stream, "]");
+    json_sink_putc(sink, ']');
 }
 
-TZOZENDEF void print_json_object(FILE *stream, Json_Object object)
+TZOZENDEF void json_write_object(Json_Sink *sink, Json_Object object)
 {
-    fprintf(stream, "{");
+    json_sink_putc(sink, '{');
     int t = 0;
     FOR_JSON (Json_Object, elem, object) {
         if (t) {
-            fprintf(stream, ",");
+            json_sink_putc(sink, ',');
         } else {
             t = 1;
         }
-        print_json_string(stream, elem->key);
-        fprintf(stream, ":");
-        print_json_value(stream, elem->value);
+        json_write_string(sink, elem->key);
+        json_sink_putc(sink, ':');
+        json_write_value(sink, elem->value);
     }
-    fprintf(stream, "}");
+    json_sink_putc(sink, '}');
 }
 
-TZOZENDEF void print_json_value(FILE *stream, Json_Value value)
+TZOZENDEF void json_write_value(Json_Sink *sink, Json_Value value)
 {
     switch (value.type) {
     case JSON_NULL: {
-        print_json_null(stream);
+        json_write_null(sink);
     } break;
     case JSON_BOOLEAN: {
-        print_json_boolean(stream, value.boolean);
+        json_write_boolean(sink, value.boolean);
     } break;
     case JSON_NUMBER: {
-        print_json_number(stream, value.number);
+        json_write_number(sink, value.number);
     } break;
     case JSON_STRING: {
-        print_json_string(stream, value.string);
+        json_write_string(sink, value.string);
     } break;
     case JSON_ARRAY: {
-        print_json_array(stream, value.array);
+        json_write_array(sink, value.array);
     } break;
     case JSON_OBJECT: {
-        print_json_object(stream, value.object);
+        json_write_object(sink, value.object);
     } break;
     }
 }
 
+TZOZENDEF void json_write_cell(Json_Sink *sink, const Json_Cell *cell)
+{
+    switch ((Json_Cell_Tag) cell->tag) {
+    case JSON_CELL_NULL: {
+        json_write_null(sink);
+    } break;
+    case JSON_CELL_FALSE:
+    case JSON_CELL_TRUE: {
+        json_write_boolean(sink, json_cell_boolean(cell));
+    } break;
+    case JSON_CELL_INTEGER: {
+        json_write_integer(sink, cell->as.integer);
+    } break;
+    case JSON_CELL_NUMBER: {
+        json_write_number(sink, *cell->as.number);
+    } break;
+    case JSON_CELL_SMALL_STRING:
+    case JSON_CELL_STRING: {
+        json_write_string(sink, json_cell_string(cell));
+    } break;
+    case JSON_CELL_ARRAY: {
+        json_sink_putc(sink, '[');
+        for (size_t i = 0; i < cell->size; ++i) {
+            if (i > 0) json_sink_putc(sink, ',');
+            json_write_cell(sink, &cell->as.elems[i]);
+        }
+        json_sink_putc(sink, ']');
+    } break;
+    case JSON_CELL_OBJECT: {
+        json_sink_putc(sink, '{');
+        for (size_t i = 0; i < cell->size; ++i) {
+            if (i > 0) json_sink_putc(sink, ',');
+            json_write_string(sink, json_cell_string(&cell->as.members[i].key));
+            json_sink_putc(sink, ':');
+            json_write_cell(sink, &cell->as.members[i].value);
+        }
+        json_sink_putc(sink, '}');
+    } break;
+    }
+}
+
+typedef struct {
+    Json_Sink *sink;
+    size_t indent;
+    size_t depth;
+    // Nothing has been written into the current container yet
+    int empty;
+    // The next value goes right after its key
+    int after_key;
+} Json_Reformatter;
+
+static int json_reformat_status(Json_Reformatter *reformatter)
+{
+    return reformatter->sink->error ? -1 : 0;
+}
+
+static void json_reformat_newline(Json_Reformatter *reformatter, size_t depth)
+{
+    static const char spaces[] = "                                ";
+
+    if (reformatter->indent == 0) return;
+
+    json_sink_putc(reformatter->sink, '\n');
+    for (size_t n = depth * reformatter->indent; n > 0;) {
+        size_t k = n < sizeof(spaces) - 1 ? n : sizeof(spaces) - 1;
+        json_sink_write(reformatter->sink, spaces, k);
+        n -= k;
+    }
+}
+
+// Goes before every key and every value
+static void json_reformat_separate(Json_Reformatter *reformatter)
+{
+    if (reformatter->after_key) {
+        reformatter->after_key = 0;
+        return;
+    }
+
+    if (reformatter->depth == 0) return;
+
+    if (!reformatter->empty) {
+        json_sink_putc(reformatter->sink, ',');
+    }
+    reformatter->empty = 0;
+    json_reformat_newline(reformatter, reformatter->depth);
+}
+
+static int json_reformat_open(Json_Reformatter *reformatter, char bracket)
+{
+    json_reformat_separate(reformatter);
+    json_sink_putc(reformatter->sink, bracket);
+    reformatter->depth += 1;
+    reformatter->empty = 1;
+    return json_reformat_status(reformatter);
+}
+
+static int json_reformat_close(Json_Reformatter *reformatter, char bracket)
+{
+    reformatter->depth -= 1;
+    if (!reformatter->empty) {
+        json_reformat_newline(reformatter, reformatter->depth);
+    }
+    json_sink_putc(reformatter->sink, bracket);
+    reformatter->empty = 0;
+    return json_reformat_status(reformatter);
+}
+
+static int json_reformat_start_array(void *data)
+{
+    return json_reformat_open((Json_Reformatter *) data, '[');
+}
+
+static int json_reformat_end_array(void *data)
+{
+    return json_reformat_close((Json_Reformatter *) data, ']');
+}
+
+static int json_reformat_start_object(void *data)
+{
+    return json_reformat_open((Json_Reformatter *) data, '{');
+}
+
+static int json_reformat_end_object(void *data)
+{
+    return json_reformat_close((Json_Reformatter *) data, '}');
+}
+
+static int json_reformat_key(void *data, Tzozen_Str key)
+{
+    Json_Reformatter *reformatter = (Json_Reformatter *) data;
+    json_reformat_separate(reformatter);
+    json_write_string(reformatter->sink, key);
+    json_sink_putc(reformatter->sink, ':');
+    if (reformatter->indent > 0) {
+        json_sink_putc(reformatter->sink, ' ');
+    }
+    reformatter->after_key = 1;
+    return json_reformat_status(reformatter);
+}
+
+static int json_reformat_string(void *data, Tzozen_Str string)
+{
+    Json_Reformatter *reformatter = (Json_Reformatter *) data;
+    json_reformat_separate(reformatter);
+    json_write_string(reformatter->sink, string);
+    return json_reformat_status(reformatter);
+}
+
+static int json_reformat_number(void *data, Json_Number number)
+{
+    Json_Reformatter *reformatter = (Json_Reformatter *) data;
+    json_reformat_separate(reformatter);
+    json_write_number(reformatter->sink, number);
+    return json_reformat_status(reformatter);
+}
+
+static int json_reformat_boolean(void *data, int boolean)
+{
+    Json_Reformatter *reformatter = (Json_Reformatter *) data;
+    json_reformat_separate(reformatter);
+    json_write_boolean(reformatter->sink, boolean);
+    return json_reformat_status(reformatter);
+}
+
+static int json_reformat_null(void *data)
+{
+    Json_Reformatter *reformatter = (Json_Reformatter *) data;
+    json_reformat_separate(reformatter);
+    json_write_null(reformatter->sink);
+    return json_reformat_status(reformatter);
+}
+
+TZOZENDEF Json_Result json_reformat(Tzozen_Memory *scratch, Tzozen_Str source, const Json_Options *options,
+                                    size_t indent, Json_Sink *sink)
+{
+    assert(sink);
+
+    Json_Reformatter reformatter;
+    memset(&reformatter, 0, sizeof(reformatter));
+    reformatter.sink = sink;
+    reformatter.indent = indent;
+
+    Json_Sax sax;
+    memset(&sax, 0, sizeof(sax));
+    sax.data = &reformatter;
+    sax.start_array = json_reformat_start_array;
+    sax.end_array = json_reformat_end_array;
+    sax.start_object = json_reformat_start_object;
+    sax.end_object = json_reformat_end_object;
+    sax.key = json_reformat_key;
+    sax.string = json_reformat_string;
+    sax.number = json_reformat_number;
+    sax.boolean = json_reformat_boolean;
+    sax.null = json_reformat_null;
+
+    Json_Result result = parse_json_sax(scratch, source, options, &sax);
+    if (sink->error) {
+        result.is_error = 1;
+        result.message = "Could not write the output";
+    }
+
+    return result;
+}
+
+#ifndef TZOZEN_NO_STDIO
+static int json_sink_file_flush(void *data, const char *bytes, size_t size)
+{
+    return fwrite(bytes, 1, size, (FILE *) data) == size ? 0 : -1;
+}
+
+TZOZENDEF Json_Sink json_sink_file(FILE *stream, char *buffer, size_t capacity)
+{
+    return json_sink_flushing(buffer, capacity, json_sink_file_flush, stream);
+}
+
+// Every print_json_*() goes through its own sink on the stack. The
+// `write` statement writes into `print_sink`.
+#define JSON_PRINT(stream, write)                                       \
+    do {                                                                \
+        char print_buffer[TZOZEN_PRINT_BUFFER_CAPACITY];                \
+        Json_Sink print_sink = json_sink_file(stream, print_buffer, sizeof(print_buffer)); \
+        write;                                                          \
+        json_sink_flush(&print_sink);                                   \
+    } while (0)
+
+TZOZENDEF void print_json_null(FILE *stream)
+{
+    JSON_PRINT(stream, json_write_null(&print_sink));
+}
+
+TZOZENDEF void print_json_boolean(FILE *stream, int boolean)
+{
+    JSON_PRINT(stream, json_write_boolean(&print_sink, boolean));
+}
+
+TZOZENDEF void print_json_number(FILE *stream, Json_Number number)
+{
+    JSON_PRINT(stream, json_write_number(&print_sink, number));
+}
+
+TZOZENDEF void print_json_string(FILE *stream, Tzozen_Str string)
+{
+    JSON_PRINT(stream, json_write_string(&print_sink, string));
+}
+
+TZOZENDEF void print_json_array(FILE *stream, Json_Array array)
+{
+    JSON_PRINT(stream, json_write_array(&print_sink, array));
+}
+
+TZOZENDEF void print_json_object(FILE *stream, Json_Object object)
+{
+    JSON_PRINT(stream, json_write_object(&print_sink, object));
+}
+
+TZOZENDEF void print_json_value(FILE *stream, Json_Value value)
+{
+    JSON_PRINT(stream, json_write_value(&print_sink, value));
+}
+
+TZOZENDEF void print_json_cell(FILE *stream, const Json_Cell *cell)
+{
+    JSON_PRINT(stream, json_write_cell(&print_sink, cell));
+}
+
 TZOZENDEF void print_json_error(FILE *stream, Json_Result result,
                                 Tzozen_Str source, const char *prefix)
 {
@@ -1181,14 +6450,117 @@ TZOZENDEF int json_get_utf8_char_len(unsigned char ch)
     }
 }
 
+static uint64_t json_rotl64(uint64_t x, int b)
+{
+    return (x << b) | (x >> (64 - b));
+}
+
+#define JSON_SIPROUND                                                   \
+    do {                                                                \
+        v0 += v1; v1 = json_rotl64(v1, 13); v1 ^= v0; v0 = json_rotl64(v0, 32); \
+        v2 += v3; v3 = json_rotl64(v3, 16); v3 ^= v2;                   \
+        v0 += v3; v3 = json_rotl64(v3, 21); v3 ^= v0;                   \
+        v2 += v1; v1 = json_rotl64(v1, 17); v1 ^= v2; v2 = json_rotl64(v2, 32); \
+    } while (0)
+
+// SipHash-1-3
+TZOZENDEF uint64_t json_hash(Json_Hash_Seed seed, Tzozen_Str key)
+{
+    uint64_t v0 = seed.k0 ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = seed.k1 ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = seed.k0 ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = seed.k1 ^ 0x7465646279746573ULL;
+
+    const uint8_t *data = (const uint8_t *) key.data;
+    size_t n = key.len;
+
+    for (; n >= 8; n -= 8, data += 8) {
+        uint64_t m = 0;
+        for (int i = 0; i < 8; ++i) m |= (uint64_t) data[i] << (8 * i);
+        v3 ^= m;
+        JSON_SIPROUND;
+        v0 ^= m;
+    }
+
+    uint64_t m = (uint64_t) key.len << 56;
+    for (size_t i = 0; i < n; ++i) m |= (uint64_t) data[i] << (8 * i);
+    v3 ^= m;
+    JSON_SIPROUND;
+    v0 ^= m;
+
+    v2 ^= 0xff;
+    JSON_SIPROUND;
+    JSON_SIPROUND;
+    JSON_SIPROUND;
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+#undef JSON_SIPROUND
+
+TZOZENDEF int json_object_hash(Tzozen_Memory *memory, Json_Object *object, Json_Hash_Seed seed)
+{
+    if (object->table != NULL) {
+        return 0;
+    }
+
+    // At most half full
+    size_t capacity = 4;
+    while (capacity < object->size * 2) capacity *= 2;
+
+    Json_Object_Table *table = TZOZEN_ALLOC(memory, Json_Object_Table, 1);
+    if (table == NULL) {
+        return -1;
+    }
+
+    Json_Object_Slot *slots = TZOZEN_ALLOC(memory, Json_Object_Slot, capacity);
+    if (slots == NULL) {
+        return -1;
+    }
+    memset(slots, 0, sizeof(Json_Object_Slot) * capacity);
+
+    FOR_JSON (Json_Object, elem, *object) {
+        uint64_t hash = json_hash(seed, elem->key);
+        size_t i = (size_t) hash & (capacity - 1);
+        while (slots[i].elem != NULL
+               && !(slots[i].hash == hash && tzozen_str_equal(slots[i].elem->key, elem->key))) {
+            i = (i + 1) & (capacity - 1);
+        }
+        // The later duplicates replace the earlier ones
+        slots[i].hash = hash;
+        slots[i].elem = elem;
+    }
+
+    table->seed = seed;
+    table->capacity = capacity;
+    table->slots = slots;
+    object->table = table;
+
+    return 0;
+}
+
 TZOZENDEF Json_Value json_object_value_by_key(Json_Object object, Tzozen_Str key)
 {
+    if (object.table != NULL) {
+        const Json_Object_Table *table = object.table;
+        uint64_t hash = json_hash(table->seed, key);
+        size_t i = (size_t) hash & (table->capacity - 1);
+        while (table->slots[i].elem != NULL) {
+            if (table->slots[i].hash == hash && tzozen_str_equal(table->slots[i].elem->key, key)) {
+                return table->slots[i].elem->value;
+            }
+            i = (i + 1) & (table->capacity - 1);
+        }
+        return json_null();
+    }
+
+    Json_Value result = json_null();
     FOR_JSON (Json_Object, element, object) {
         if (tzozen_str_equal(element->key, key)) {
-            return element->value;
+            result = element->value;
         }
     }
-    return json_null();
+    return result;
 }
 
 #endif // TZOZEN_IMPLEMENTATION
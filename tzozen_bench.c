@@ -0,0 +1,193 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TZOZEN_STATIC
+#define TZOZEN_IMPLEMENTATION
+#include "tzozen.h"
+
+// Throughput of the parser on generated documents. `make bench` builds
+// this file twice: against the baseline tzozen.h with
+// TZOZEN_BENCH_BASELINE, which only touches the baseline API, and
+// against the current one, which then compares itself to the baseline
+// output. The best of RUNS is taken, since the noise only slows down.
+
+#define RUNS 15
+#define RECORDS_COUNT 200000
+#define DEFAULT_TOLERANCE 0.9
+
+typedef struct {
+    const char *name;
+    double mbps;
+} Bench_Result;
+
+#define RESULTS_CAPACITY 16
+Bench_Result results[RESULTS_CAPACITY];
+size_t results_count = 0;
+
+double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+char *generate_minified(size_t *size)
+{
+    size_t capacity = RECORDS_COUNT * 256;
+    char *text = malloc(capacity);
+    size_t n = 0;
+
+    text[n++] = '[';
+    for (size_t i = 0; i < RECORDS_COUNT; ++i) {
+        n += (size_t) snprintf(text + n, capacity - n,
+            "%s{\"id\":%zu,\"name\":\"user %zu\",\"email\":\"user%zu@example.com\","
+            "\"active\":%s,\"score\":%zu.%02zu,\"tags\":[\"a\",\"b\\n\",\"c\"],"
+            "\"address\":{\"city\":\"City %zu\",\"zip\":\"%05zu\"},\"note\":null}",
+            i > 0 ? "," : "", i, i, i, i % 2 ? "true" : "false",
+            i % 1000, i % 100, i % 97, i % 100000);
+    }
+    text[n++] = ']';
+
+    *size = n;
+    return text;
+}
+
+// Every element on its own line, indented by 2 spaces per level
+char *generate_pretty(const char *minified, size_t minified_size, size_t *size)
+{
+    char *text = malloc(minified_size * 4);
+    size_t n = 0;
+    size_t depth = 0;
+    int in_string = 0;
+
+    for (size_t i = 0; i < minified_size; ++i) {
+        char c = minified[i];
+        if (in_string) {
+            text[n++] = c;
+            if (c == '\\') {
+                text[n++] = minified[++i];
+            } else if (c == '"') {
+                in_string = 0;
+            }
+            continue;
+        }
+
+        if (c == ']' || c == '}') {
+            depth -= 1;
+            text[n++] = '\n';
+            for (size_t j = 0; j < depth * 2; ++j) text[n++] = ' ';
+        }
+        text[n++] = c;
+        if (c == '"') {
+            in_string = 1;
+        } else if (c == ':') {
+            text[n++] = ' ';
+        } else if (c == '[' || c == '{' || c == ',') {
+            if (c != ',') depth += 1;
+            text[n++] = '\n';
+            for (size_t j = 0; j < depth * 2; ++j) text[n++] = ' ';
+        }
+    }
+
+    *size = n;
+    return text;
+}
+
+void report(const char *name, size_t size, double seconds)
+{
+    results[results_count].name = name;
+    results[results_count].mbps = (double) size / seconds / 1e6;
+    printf("%s %.1f\n", name, results[results_count].mbps);
+    fflush(stdout);
+    results_count += 1;
+}
+
+void bench_parse(const char *name, Tzozen_Str source, Tzozen_Memory *memory)
+{
+    double best = 1e9;
+    for (int run = 0; run < RUNS; ++run) {
+        memory->size = 0;
+        double start = now();
+        Json_Result result = parse_json_value(memory, source);
+        double seconds = now() - start;
+        if (result.is_error) {
+            fprintf(stderr, "%s: %s\n", name, result.message);
+            exit(1);
+        }
+        if (seconds < best) best = seconds;
+    }
+    report(name, source.len, best);
+}
+
+#ifndef TZOZEN_BENCH_BASELINE
+double result_mbps(const char *name)
+{
+    for (size_t i = 0; i < results_count; ++i) {
+        if (strcmp(results[i].name, name) == 0) return results[i].mbps;
+    }
+    return 0.0;
+}
+
+// Fails if `name` is slower than `expected` MB/s by more than the tolerance
+int check_throughput(const char *name, const char *against, double expected, double tolerance)
+{
+    double actual = result_mbps(name);
+    if (actual < expected * tolerance) {
+        fprintf(stderr, "[ERROR] %s: %.1f MB/s is slower than %s at %.1f MB/s\n",
+                name, actual, against, expected);
+        return -1;
+    }
+    return 0;
+}
+#endif // TZOZEN_BENCH_BASELINE
+
+int main(int argc, char *argv[])
+{
+    const char *baseline_file_path = NULL;
+    double tolerance = DEFAULT_TOLERANCE;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-baseline") == 0) {
+            baseline_file_path = argv[i + 1];
+        } else if (strcmp(argv[i], "-tolerance") == 0) {
+            tolerance = strtod(argv[i + 1], NULL);
+        }
+    }
+
+    size_t minified_size = 0;
+    char *minified = generate_minified(&minified_size);
+    size_t pretty_size = 0;
+    char *pretty = generate_pretty(minified, minified_size, &pretty_size);
+
+    size_t capacity = pretty_size * 8;
+    Tzozen_Memory memory = tzozen_memory(malloc(capacity), capacity);
+
+    bench_parse("minified", tzozen_str(minified_size, minified), &memory);
+    bench_parse("pretty", tzozen_str(pretty_size, pretty), &memory);
+
+#ifdef TZOZEN_BENCH_BASELINE
+    (void) baseline_file_path;
+    (void) tolerance;
+    return 0;
+#else
+    int failed = 0;
+
+    if (baseline_file_path != NULL) {
+        FILE *baseline = fopen(baseline_file_path, "r");
+        if (baseline == NULL) {
+            fprintf(stderr, "Could not open file `%s`\n", baseline_file_path);
+            return 1;
+        }
+
+        char name[64];
+        double mbps;
+        while (fscanf(baseline, "%63s %lf", name, &mbps) == 2) {
+            failed |= check_throughput(name, "the baseline", mbps, tolerance);
+        }
+        fclose(baseline);
+    }
+
+    return failed ? 1 : 0;
+#endif // TZOZEN_BENCH_BASELINE
+}
@@ -76,6 +76,10 @@ void json_array_elem_relatify(Tzozen_Memory *memory, Json_Array_Elem *elem)
 
 void json_array_relatify(Tzozen_Memory *memory, Json_Array *array)
 {
+    for (size_t i = 0; array->elems != NULL && i < array->size; ++i) {
+        RELATIFY_PTR(memory, array->elems[i]);
+    }
+    RELATIFY_PTR(memory, array->elems);
     json_array_elem_relatify(memory, array->begin);
     RELATIFY_PTR(memory, array->begin);
     RELATIFY_PTR(memory, array->end);
@@ -94,6 +98,17 @@ void json_object_elem_relatify(Tzozen_Memory *memory, Json_Object_Elem *elem)
 
 void json_object_relatify(Tzozen_Memory *memory, Json_Object *object)
 {
+    for (size_t i = 0; object->elems != NULL && i < object->size; ++i) {
+        RELATIFY_PTR(memory, object->elems[i]);
+    }
+    RELATIFY_PTR(memory, object->elems);
+    if (object->table != NULL) {
+        for (size_t i = 0; i < object->table->capacity; ++i) {
+            RELATIFY_PTR(memory, object->table->slots[i].elem);
+        }
+        RELATIFY_PTR(memory, object->table->slots);
+    }
+    RELATIFY_PTR(memory, object->table);
     json_object_elem_relatify(memory, object->begin);
     RELATIFY_PTR(memory, object->begin);
     RELATIFY_PTR(memory, object->end);
@@ -195,6 +210,10 @@ void json_array_unrelatify(Tzozen_Memory *memory, Json_Array *array)
 {
     UNRELATIFY_PTR(memory, array->begin);
     UNRELATIFY_PTR(memory, array->end);
+    UNRELATIFY_PTR(memory, array->elems);
+    for (size_t i = 0; array->elems != NULL && i < array->size; ++i) {
+        UNRELATIFY_PTR(memory, array->elems[i]);
+    }
     json_array_elem_unrelatify(memory, array->begin);
 }
 
@@ -213,6 +232,17 @@ void json_object_unrelatify(Tzozen_Memory *memory, Json_Object *object)
 {
     UNRELATIFY_PTR(memory, object->begin);
     UNRELATIFY_PTR(memory, object->end);
+    UNRELATIFY_PTR(memory, object->elems);
+    UNRELATIFY_PTR(memory, object->table);
+    if (object->table != NULL) {
+        UNRELATIFY_PTR(memory, object->table->slots);
+        for (size_t i = 0; i < object->table->capacity; ++i) {
+            UNRELATIFY_PTR(memory, object->table->slots[i].elem);
+        }
+    }
+    for (size_t i = 0; object->elems != NULL && i < object->size; ++i) {
+        UNRELATIFY_PTR(memory, object->elems[i]);
+    }
     json_object_elem_unrelatify(memory, object->begin);
 }
 
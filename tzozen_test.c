@@ -1,3 +1,4 @@
+#define _POSIX_C_SOURCE 200809L // open_memstream
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
@@ -10,18 +11,48 @@
 #define ARRAY_SIZE(xs) (sizeof(xs) / sizeof((xs)[0]))
 #define TESTING_FOLDER "./tests/"
 
-uint8_t memory_buffer[100 * 1000 * 1000];
+void *test_alloc(void *data, size_t size)
+{
+    (void) data;
+    return malloc(size);
+}
+
+void test_free(void *data, void *block, size_t size)
+{
+    (void) data;
+    (void) size;
+    free(block);
+}
+
+const Tzozen_Allocator test_allocator = {
+    .alloc = test_alloc,
+    .free = test_free,
+};
+
+// The memories are small on purpose, so the parsers keep crossing
+// into new blocks
+uint8_t memory_buffer[64 * 1000];
 Tzozen_Memory memory = {
     .capacity = ARRAY_SIZE(memory_buffer),
     .buffer = memory_buffer,
+    .allocator = &test_allocator,
+    .block_size = 64 * 1000,
 };
 
-uint8_t dump_memory_buffer[ARRAY_SIZE(memory_buffer)];
+uint8_t dump_memory_buffer[100 * 1000 * 1000];
 Tzozen_Memory dump_memory = {
     .capacity = ARRAY_SIZE(dump_memory_buffer),
     .buffer = dump_memory_buffer,
 };
 
+uint8_t tape_memory_buffer[4 * 1000];
+Tzozen_Memory tape_memory = {
+    .capacity = ARRAY_SIZE(tape_memory_buffer),
+    .buffer = tape_memory_buffer,
+    .allocator = &test_allocator,
+    .block_size = 4 * 1000,
+};
+
 char ast_dump_filepath[1024];
 char json_filepath[1024];
 
@@ -96,6 +127,954 @@ int json_value_equals(Json_Value a, Json_Value b)
     return 0;
 }
 
+// Checks json_number_to_double() against strtod() for every number in the value
+void check_numbers(Json_Value value)
+{
+    switch (value.type) {
+    case JSON_NULL:
+    case JSON_BOOLEAN:
+    case JSON_STRING:
+        break;
+    case JSON_NUMBER: {
+        char literal[1024];
+        snprintf(literal, ARRAY_SIZE(literal), TSTR_Fmt"."TSTR_Fmt"e"TSTR_Fmt,
+                 TSTR_Arg(value.number.integer),
+                 TSTR_Arg(value.number.fraction),
+                 TSTR_Arg(value.number.exponent));
+        double expected = strtod(literal, NULL);
+        double actual = json_number_to_double(value.number);
+        if (memcmp(&expected, &actual, sizeof(double)) != 0) {
+            fprintf(stderr, "FAILED! json_number_to_double(%s) == %.17g, expected %.17g\n",
+                    literal, actual, expected);
+            exit(1);
+        }
+    } break;
+    case JSON_ARRAY:
+        FOR_JSON (Json_Array, elem, value.array) check_numbers(elem->value);
+        break;
+    case JSON_OBJECT:
+        FOR_JSON (Json_Object, elem, value.object) check_numbers(elem->value);
+        break;
+    }
+}
+
+// Checks the sizes and the element vectors of all the containers in the value
+void check_containers(Json_Value value)
+{
+    size_t i = 0;
+    switch (value.type) {
+    case JSON_NULL:
+    case JSON_BOOLEAN:
+    case JSON_NUMBER:
+    case JSON_STRING:
+        return;
+    case JSON_ARRAY:
+        FOR_JSON (Json_Array, elem, value.array) {
+            if (i >= json_array_size(value.array) || value.array.elems[i] != elem) goto fail;
+            i += 1;
+            check_containers(elem->value);
+        }
+        if (i == json_array_size(value.array)) return;
+        break;
+    case JSON_OBJECT:
+        FOR_JSON (Json_Object, elem, value.object) {
+            if (i >= json_object_size(value.object) || json_object_at(value.object, i) != elem) goto fail;
+            i += 1;
+
+            // The last duplicate wins
+            Json_Object_Elem *last = elem;
+            for (Json_Object_Elem *next = elem->next; next != NULL; next = next->next) {
+                if (tzozen_str_equal(next->key, elem->key)) last = next;
+            }
+            // The keys are interned
+            if (value.object.table == NULL
+                || last->key.data != elem->key.data
+                || !json_value_equals(json_object_value_by_key(value.object, elem->key), last->value)) {
+                goto fail;
+            }
+
+            check_containers(elem->value);
+        }
+        if (i == json_object_size(value.object)) return;
+        break;
+    }
+
+fail:
+    fprintf(stderr, "FAILED WITH THE INDEXED CONTAINERS!\n");
+    print_json_value(stderr, value);
+    fputc('\n', stderr);
+    exit(1);
+}
+
+// The document must fit exactly into the memory json_measure() asks
+// for. If the options have the bytes memory, it is replaced with an
+// exact one too.
+void check_measure(Tzozen_Str source, Json_Options options, const char *mode)
+{
+    size_t size = 0;
+    size_t bytes_size = 0;
+    Json_Result result = json_measure(source, &options, &size, &bytes_size);
+    if (result.is_error) {
+        fprintf(stderr, "FAILED TO MEASURE %s!\n", mode);
+        print_json_error(stderr, result, source, json_filepath);
+        exit(1);
+    }
+
+    uint8_t *buffer = malloc(size + 1);
+    Tzozen_Memory exact = tzozen_memory(buffer, size);
+    uint8_t *bytes_buffer = malloc(bytes_size + 1);
+    Tzozen_Memory bytes = tzozen_memory(bytes_buffer, bytes_size);
+    if (options.bytes != NULL) {
+        options.bytes = &bytes;
+    }
+
+    result = parse_json_value_with_options(&exact, source, &options);
+    if (result.is_error || exact.size != size || bytes.size != bytes_size) {
+        fprintf(stderr, "FAILED TO MEASURE %s! Measured %zu+%zu bytes, but the parse took %zu+%zu\n",
+                mode, size, bytes_size, exact.size, bytes.size);
+        exit(1);
+    }
+
+    free(buffer);
+    free(bytes_buffer);
+}
+
+void check_result(Json_Result result, Tzozen_Str source, Json_Value expected, const char *mode)
+{
+    if (result.is_error) {
+        fprintf(stderr, "FAILED WITH %s!\n", mode);
+        print_json_error(stderr, result, source, json_filepath);
+        exit(1);
+    }
+
+    if (!json_value_equals(result.value, expected)) {
+        fprintf(stderr, "FAILED WITH %s!\n", mode);
+        fprintf(stderr, "Expected: ");
+        print_json_value(stderr, expected);
+        fputc('\n', stderr);
+
+        fprintf(stderr, "Actual:   ");
+        print_json_value(stderr, result.value);
+        fputc('\n', stderr);
+
+        exit(1);
+    }
+}
+
+// Compares the value that starts at the word `i` of the tape with `value`
+int json_tape_equals(Json_Tape tape, size_t i, Json_Value value)
+{
+    if (json_tape_type(tape, i) != value.type) return 0;
+
+    switch (value.type) {
+    case JSON_NULL: return 1;
+    case JSON_BOOLEAN: return json_tape_boolean(tape, i) == value.boolean;
+    case JSON_NUMBER: return json_number_equals(json_tape_number(tape, i), value.number);
+    case JSON_STRING: return tzozen_str_equal(json_tape_string(tape, i), value.string);
+    case JSON_ARRAY: {
+        Json_Array_Elem *elem = value.array.begin;
+        FOR_JSON_TAPE (tape, tape_elem, i) {
+            if (elem == NULL || !json_tape_equals(tape, tape_elem, elem->value)) return 0;
+            elem = elem->next;
+        }
+        return elem == NULL;
+    }
+    case JSON_OBJECT: {
+        Json_Object_Elem *elem = value.object.begin;
+        FOR_JSON_TAPE (tape, key, i) {
+            if (elem == NULL
+                || !tzozen_str_equal(json_tape_string(tape, key), elem->key)
+                || !json_tape_equals(tape, json_tape_object_value(tape, key), elem->value)) {
+                return 0;
+            }
+            elem = elem->next;
+        }
+        return elem == NULL;
+    }
+    }
+
+    return 0;
+}
+
+// Prints the events the same way print_json_value() prints the tree
+typedef struct {
+    FILE *stream;
+    // Whether the next value in the current container needs a comma
+    int comma;
+} Sax_Printer;
+
+void sax_printer_separate(Sax_Printer *printer)
+{
+    if (printer->comma) fputc(',', printer->stream);
+    printer->comma = 1;
+}
+
+int sax_printer_open(Sax_Printer *printer, char bracket)
+{
+    sax_printer_separate(printer);
+    fputc(bracket, printer->stream);
+    printer->comma = 0;
+    return 0;
+}
+
+int sax_printer_close(Sax_Printer *printer, char bracket)
+{
+    fputc(bracket, printer->stream);
+    printer->comma = 1;
+    return 0;
+}
+
+int sax_start_array(void *data) { return sax_printer_open(data, '['); }
+int sax_end_array(void *data) { return sax_printer_close(data, ']'); }
+int sax_start_object(void *data) { return sax_printer_open(data, '{'); }
+int sax_end_object(void *data) { return sax_printer_close(data, '}'); }
+
+int sax_key(void *data, Tzozen_Str key)
+{
+    Sax_Printer *printer = data;
+    sax_printer_separate(printer);
+    print_json_string(printer->stream, key);
+    fputc(':', printer->stream);
+    printer->comma = 0;
+    return 0;
+}
+
+int sax_string(void *data, Tzozen_Str string)
+{
+    sax_printer_separate(data);
+    print_json_string(((Sax_Printer *) data)->stream, string);
+    return 0;
+}
+
+int sax_number(void *data, Json_Number number)
+{
+    sax_printer_separate(data);
+    print_json_number(((Sax_Printer *) data)->stream, number);
+    return 0;
+}
+
+int sax_boolean(void *data, int boolean)
+{
+    sax_printer_separate(data);
+    print_json_boolean(((Sax_Printer *) data)->stream, boolean);
+    return 0;
+}
+
+int sax_null(void *data)
+{
+    sax_printer_separate(data);
+    print_json_null(((Sax_Printer *) data)->stream);
+    return 0;
+}
+
+// Walks the source with the cursor alongside the expected tree
+int cursor_equals(Tzozen_Str value, Json_Value expected)
+{
+    Json_Cursor cursor;
+    Tzozen_Str key;
+    Tzozen_Str elem_value;
+
+    switch (expected.type) {
+    case JSON_NULL:
+    case JSON_BOOLEAN:
+    case JSON_NUMBER:
+    case JSON_STRING: {
+        Json_Result result = parse_json_value(&memory, value);
+        return !result.is_error && result.rest.len == 0 && json_value_equals(result.value, expected);
+    }
+    case JSON_ARRAY:
+        if (json_cursor_enter(&cursor, value) < 0) return 0;
+        FOR_JSON (Json_Array, elem, expected.array) {
+            if (json_cursor_next(&cursor, NULL, &elem_value) <= 0) return 0;
+            if (!cursor_equals(elem_value, elem->value)) return 0;
+        }
+        return json_cursor_next(&cursor, NULL, NULL) == 0;
+    case JSON_OBJECT:
+        if (json_cursor_enter(&cursor, value) < 0) return 0;
+        FOR_JSON (Json_Object, elem, expected.object) {
+            if (json_cursor_next(&cursor, &key, &elem_value) <= 0) return 0;
+            if (!json_literal_equal(key, elem->key)) return 0;
+            if (!cursor_equals(elem_value, elem->value)) return 0;
+
+            // Finds the first member with that key
+            Json_Object_Elem *first = expected.object.begin;
+            while (!tzozen_str_equal(first->key, elem->key)) first = first->next;
+            Json_Cursor lookup;
+            Tzozen_Str found;
+            json_cursor_enter(&lookup, value);
+            if (json_cursor_find(&lookup, elem->key, &found) <= 0) return 0;
+            if (!cursor_equals(found, first->value)) return 0;
+        }
+        return json_cursor_next(&cursor, NULL, NULL) == 0;
+    }
+
+    return 0;
+}
+
+void check_sax(Tzozen_Str source, Json_Value expected)
+{
+    char *expected_text = NULL;
+    size_t expected_size = 0;
+    FILE *stream = open_memstream(&expected_text, &expected_size);
+    print_json_value(stream, expected);
+    fclose(stream);
+
+    char *actual_text = NULL;
+    size_t actual_size = 0;
+    Sax_Printer printer = {open_memstream(&actual_text, &actual_size), 0};
+    Json_Sax sax = {
+        .data = &printer,
+        .start_array = sax_start_array,
+        .end_array = sax_end_array,
+        .start_object = sax_start_object,
+        .end_object = sax_end_object,
+        .key = sax_key,
+        .string = sax_string,
+        .number = sax_number,
+        .boolean = sax_boolean,
+        .null = sax_null,
+    };
+    // The reformatter goes without the stack
+    Json_Frame stack[64];
+    Json_Options options = {0};
+    options.stack = stack;
+    options.stack_capacity = ARRAY_SIZE(stack);
+    size_t memory_size = memory.size;
+    Json_Result result = parse_json_sax(&memory, source, &options, &sax);
+    fclose(printer.stream);
+
+    if (result.is_error) {
+        fprintf(stderr, "FAILED WITH THE SAX PARSER!\n");
+        print_json_error(stderr, result, source, json_filepath);
+        exit(1);
+    }
+
+    if (memory.size != memory_size
+        || expected_size != actual_size
+        || memcmp(expected_text, actual_text, actual_size) != 0) {
+        fprintf(stderr, "FAILED WITH THE SAX PARSER!\n");
+        fprintf(stderr, "Expected: %s\n", expected_text);
+        fprintf(stderr, "Actual:   %s\n", actual_text);
+        exit(1);
+    }
+
+    free(expected_text);
+    free(actual_text);
+}
+
+int sink_flush(void *data, const char *bytes, size_t size)
+{
+    return fwrite(bytes, 1, size, (FILE *) data) == size ? 0 : -1;
+}
+
+void check_sink(Json_Value expected)
+{
+    char *expected_text = NULL;
+    size_t expected_size = 0;
+    FILE *stream = open_memstream(&expected_text, &expected_size);
+    print_json_value(stream, expected);
+    fclose(stream);
+
+    // Exactly the size of the output, and one byte short of it
+    char *buffer = malloc(expected_size + 1);
+    Json_Sink exact = json_sink_buffer(buffer, expected_size);
+    json_write_value(&exact, expected);
+    int exact_failed = json_sink_flush(&exact) < 0
+        || exact.size != expected_size
+        || memcmp(buffer, expected_text, expected_size) != 0;
+    Json_Sink short_sink = json_sink_buffer(buffer, expected_size - 1);
+    json_write_value(&short_sink, expected);
+
+    // Nothing gets into the buffer after the overflow, even if it fits
+    size_t overflowed_size = short_sink.size;
+    json_sink_write(&short_sink, "", 0);
+    json_sink_putc(&short_sink, ' ');
+    json_write_null(&short_sink);
+    int overflow_failed = !short_sink.error || short_sink.size != overflowed_size;
+
+    // A tiny buffer flushes all the time
+    char *actual_text = NULL;
+    size_t actual_size = 0;
+    char tiny[3];
+    stream = open_memstream(&actual_text, &actual_size);
+    Json_Sink flushing = json_sink_flushing(tiny, sizeof(tiny), sink_flush, stream);
+    json_write_value(&flushing, expected);
+    json_sink_flush(&flushing);
+    fclose(stream);
+
+    // The output must parse back into the same value
+    Json_Result reparsed = parse_json_value(&memory, tzozen_str(expected_size, expected_text));
+
+    if (exact_failed
+        || overflow_failed
+        || reparsed.is_error
+        || !json_value_equals(reparsed.value, expected)
+        || json_sink_flush(&short_sink) == 0
+        || expected_size != actual_size
+        || memcmp(expected_text, actual_text, actual_size) != 0) {
+        fprintf(stderr, "FAILED WITH THE SINK!\n");
+        fprintf(stderr, "Expected: %s\n", expected_text);
+        fprintf(stderr, "Actual:   %s\n", actual_text);
+        exit(1);
+    }
+
+    free(buffer);
+    free(expected_text);
+    free(actual_text);
+}
+
+void check_reformat(Tzozen_Str source, Json_Value expected)
+{
+    char *expected_text = NULL;
+    size_t expected_size = 0;
+    FILE *stream = open_memstream(&expected_text, &expected_size);
+    print_json_value(stream, expected);
+    fclose(stream);
+
+    // Minified output is the same as the one of the printer
+    char *minified_text = NULL;
+    size_t minified_size = 0;
+    char buffer[16];
+    stream = open_memstream(&minified_text, &minified_size);
+    Json_Sink sink = json_sink_flushing(buffer, sizeof(buffer), sink_flush, stream);
+    Json_Result minified = json_reformat(&memory, source, NULL, 0, &sink);
+    json_sink_flush(&sink);
+    fclose(stream);
+
+    // Indented output parses back into the same value
+    char *indented_text = NULL;
+    size_t indented_size = 0;
+    stream = open_memstream(&indented_text, &indented_size);
+    sink = json_sink_flushing(buffer, sizeof(buffer), sink_flush, stream);
+    Json_Result indented = json_reformat(&memory, source, NULL, 3, &sink);
+    json_sink_flush(&sink);
+    fclose(stream);
+    Json_Result reparsed = parse_json_value(&memory, tzozen_str(indented_size, indented_text));
+
+    if (minified.is_error || indented.is_error || reparsed.is_error
+        || expected_size != minified_size
+        || memcmp(expected_text, minified_text, minified_size) != 0
+        || !json_value_equals(reparsed.value, expected)) {
+        fprintf(stderr, "FAILED WITH THE REFORMATTER!\n");
+        fprintf(stderr, "Expected: %s\n", expected_text);
+        fprintf(stderr, "Minified: %s\n", minified_text);
+        fprintf(stderr, "Indented: %s\n", indented_text);
+        exit(1);
+    }
+
+    free(expected_text);
+    free(minified_text);
+    free(indented_text);
+}
+
+void check_cells(Tzozen_Str source, Json_Value expected, const Json_Options *options, const char *mode)
+{
+    Json_Cell cell;
+    Tzozen_Memory_Mark scratch_mark = tzozen_memory_save(&tape_memory);
+    Json_Result result = parse_json_cells(&memory, &tape_memory, source, options, &cell);
+    if (result.is_error) {
+        fprintf(stderr, "FAILED WITH THE CELLS AND %s!\n", mode);
+        print_json_error(stderr, result, source, json_filepath);
+        exit(1);
+    }
+    if (tape_memory.buffer != scratch_mark.buffer || tape_memory.size != scratch_mark.size) {
+        fprintf(stderr, "FAILED WITH THE CELLS AND %s! The scratch is not given back\n", mode);
+        exit(1);
+    }
+
+    char *expected_text = NULL;
+    size_t expected_size = 0;
+    FILE *stream = open_memstream(&expected_text, &expected_size);
+    print_json_value(stream, expected);
+    fclose(stream);
+
+    char *actual_text = NULL;
+    size_t actual_size = 0;
+    stream = open_memstream(&actual_text, &actual_size);
+    print_json_cell(stream, &cell);
+    fclose(stream);
+
+    if (expected_size != actual_size
+        || memcmp(expected_text, actual_text, actual_size) != 0
+        || (cell.tag == JSON_CELL_OBJECT && cell.size > 0
+            && json_cell_find(&cell, json_cell_string(&json_cell_member(&cell, 0)->key)) == NULL)) {
+        fprintf(stderr, "FAILED WITH THE CELLS AND %s!\n", mode);
+        fprintf(stderr, "Expected: %s\n", expected_text);
+        fprintf(stderr, "Actual:   %s\n", actual_text);
+        exit(1);
+    }
+
+    free(expected_text);
+    free(actual_text);
+}
+
+// Feeds the source in chunks of `chunk` bytes, or of random sizes up to
+// 64 bytes if it is 0, and finishes the document
+Json_Push_Status push_source(Json_Push_Parser *parser, Tzozen_Str source, size_t chunk)
+{
+    while (source.len > 0) {
+        size_t n = chunk > 0 ? chunk : 1 + (size_t) rand() % 64;
+        if (n > source.len) n = source.len;
+        json_push_feed(parser, tzozen_str_take(source, n));
+        tzozen_str_chop(&source, n);
+    }
+    return json_push_finish(parser);
+}
+
+typedef struct {
+    const char *input;
+    const char *message;
+    size_t position;
+} Push_Error_Case;
+
+const Push_Error_Case push_error_cases[] = {
+    {"[1, \"two\", {\"three\": 3", "EOF", 22},
+    {"{\"key\": \"unfinished", "EOF", 19},
+    {"[true, tru", "EOF", 10},
+    {"[\"x\", trux]", "Expected `true`", 9},
+    {"{\"a\": nul1}", "Expected `null`", 9},
+    {"[1, 2] [3]", "Unexpected data after the value", 7},
+    {"\"done\" x", "Unexpected data after the value", 7},
+    {"{\"a\" 1}", "Expected ':'", 5},
+    {"[1 2]", "Expected ']' or ','", 3},
+    {"-", "Incorrect number literal", 1},
+};
+
+void check_push_errors(void)
+{
+    const size_t chunks[] = {1, 2, 3, 5, 0, 1000};
+
+    for (size_t i = 0; i < ARRAY_SIZE(push_error_cases); ++i) {
+        const Push_Error_Case *c = &push_error_cases[i];
+        for (size_t j = 0; j < ARRAY_SIZE(chunks); ++j) {
+            Json_Push_Parser parser;
+            if (json_push_init(&parser, &memory, NULL) < 0) {
+                fprintf(stderr, "Could not create the push parser\n");
+                exit(1);
+            }
+
+            Json_Push_Status status = push_source(&parser, tzozen_str(strlen(c->input), c->input), chunks[j]);
+            if (status != JSON_PUSH_ERROR
+                || strcmp(parser.message, c->message) != 0
+                || parser.position != c->position
+                // Everything after the start of the document is given back
+                || memory.buffer != parser.mark.buffer
+                || memory.size != parser.mark.size) {
+                fprintf(stderr, "FAILED WITH THE PUSH PARSER ON `%s` IN CHUNKS OF %zu!\n", c->input, chunks[j]);
+                fprintf(stderr, "%zu: %s\n", parser.position, status == JSON_PUSH_ERROR ? parser.message : "no error");
+                exit(1);
+            }
+        }
+    }
+}
+
+typedef struct {
+    const char *input;
+    const char *message;
+    size_t position;
+} Split_Error_Case;
+
+// A trailing comma is found by json_array_split() when it ends up alone
+// in the last slice and by parse_json_elements() otherwise
+const Split_Error_Case split_error_cases[] = {
+    {"[1,]", "Expected value after ','", 3},
+    {"[1, 2, ]", "Expected value after ','", 7},
+    {"[1 2]", "Expected ']' or ','", 3},
+    {"[1, 2", "Expected ']' or ','", 5},
+    {"{\"a\": 1}", "Expected '['", 0},
+};
+
+void check_split_errors(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(split_error_cases); ++i) {
+        const Split_Error_Case *c = &split_error_cases[i];
+        Tzozen_Str source = tzozen_str(strlen(c->input), c->input);
+
+        Tzozen_Str slices[3];
+        size_t slices_count = 0;
+        Json_Result result = json_array_split(source, slices, ARRAY_SIZE(slices), &slices_count);
+        for (size_t j = 0; !result.is_error && j < slices_count; ++j) {
+            result = parse_json_elements(&memory, slices[j], NULL);
+        }
+
+        if (!result.is_error
+            || strcmp(result.message, c->message) != 0
+            || (size_t) (result.rest.data - source.data) != c->position) {
+            fprintf(stderr, "FAILED WITH THE ARRAY SPLIT ON `%s`!\n", c->input);
+            if (result.is_error) {
+                fprintf(stderr, "%zu: %s\n", (size_t) (result.rest.data - source.data), result.message);
+            }
+            exit(1);
+        }
+    }
+}
+
+// Blank lines, CRLF, an error and a last line with no line break
+const char lines_source[] =
+    "{\"a\": 1}\n"
+    "\n"
+    "   \n"
+    "[1, 2]\r\n"
+    "1 2\n"
+    "\"x\"\n"
+    "  true  \n"
+    "null";
+
+typedef struct {
+    const char *line;
+    // NULL if the line parses
+    const char *message;
+    size_t error_offset;
+} Line_Case;
+
+const Line_Case line_cases[] = {
+    {"{\"a\": 1}", NULL, 0},
+    {"[1, 2]\r", NULL, 0},
+    {"1 2", "Unexpected data after the value", 2},
+    {"\"x\"", NULL, 0},
+    {"  true  ", NULL, 0},
+    {"null", NULL, 0},
+};
+
+void check_line(const Json_Line *line, size_t i)
+{
+    const Line_Case *c = &line_cases[i];
+    int failed = !tzozen_str_equal(line->line, tzozen_str(strlen(c->line), c->line));
+    if (c->message == NULL) {
+        failed = failed || line->result.is_error;
+    } else {
+        failed = failed
+            || !line->result.is_error
+            || strcmp(line->result.message, c->message) != 0
+            || line->result.rest.data != line->line.data + c->error_offset;
+    }
+
+    if (failed) {
+        fprintf(stderr, "FAILED WITH THE JSON LINE %zu: `%.*s`!\n", i, (int) line->line.len, line->line.data);
+        exit(1);
+    }
+}
+
+void check_lines(void)
+{
+    Tzozen_Str source = tzozen_str(sizeof(lines_source) - 1, lines_source);
+    Json_Line lines[ARRAY_SIZE(line_cases) + 1];
+
+    // Every capacity must give the same lines, only in more calls
+    for (size_t capacity = 1; capacity <= ARRAY_SIZE(lines); ++capacity) {
+        Tzozen_Str rest = source;
+        size_t total = 0;
+        size_t n;
+        while ((n = parse_json_lines(&memory, &rest, NULL, lines, capacity)) > 0) {
+            if (n > capacity || total + n > ARRAY_SIZE(line_cases)) {
+                fprintf(stderr, "FAILED WITH THE JSON LINES CAPACITY %zu!\n", capacity);
+                exit(1);
+            }
+            for (size_t i = 0; i < n; ++i) check_line(&lines[i], total + i);
+            total += n;
+        }
+        if (total != ARRAY_SIZE(line_cases) || rest.len != 0) {
+            fprintf(stderr, "FAILED WITH THE JSON LINES CAPACITY %zu!\n", capacity);
+            exit(1);
+        }
+    }
+
+    // The memory of a line with trailing data is given back
+    Tzozen_Str trailing = TSTR("[1, \"two\", {\"three\": 3}] x\n");
+    Tzozen_Memory_Mark mark = tzozen_memory_save(&memory);
+    if (parse_json_lines(&memory, &trailing, NULL, lines, 1) != 1
+        || !lines[0].result.is_error
+        || strcmp(lines[0].result.message, "Unexpected data after the value") != 0
+        || memory.buffer != mark.buffer
+        || memory.size != mark.size) {
+        fprintf(stderr, "FAILED TO ROLL BACK A JSON LINE WITH TRAILING DATA!\n");
+        exit(1);
+    }
+
+    // The chunks cover the source in order and end at the line breaks
+    Tzozen_Str chunks[8];
+    for (size_t count = 1; count <= ARRAY_SIZE(chunks); ++count) {
+        size_t n = json_lines_split(source, chunks, count);
+        const char *at = source.data;
+        size_t total = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (chunks[i].data != at
+                || chunks[i].len == 0
+                || (i + 1 < n && chunks[i].data[chunks[i].len - 1] != '\n')) {
+                fprintf(stderr, "FAILED TO SPLIT THE JSON LINES INTO %zu!\n", count);
+                exit(1);
+            }
+            at += chunks[i].len;
+
+            Tzozen_Str rest = chunks[i];
+            size_t m;
+            while ((m = parse_json_lines(&memory, &rest, NULL, lines, ARRAY_SIZE(lines))) > 0) {
+                for (size_t j = 0; j < m; ++j) check_line(&lines[j], total + j);
+                total += m;
+            }
+        }
+        if (n == 0 || n > count || at != source.data + source.len || total != ARRAY_SIZE(line_cases)) {
+            fprintf(stderr, "FAILED TO SPLIT THE JSON LINES INTO %zu!\n", count);
+            exit(1);
+        }
+    }
+
+    Tzozen_Str single = TSTR("[1, 2, 3]");
+    if (json_lines_split(single, chunks, ARRAY_SIZE(chunks)) != 1 || chunks[0].len != single.len) {
+        fprintf(stderr, "FAILED TO SPLIT A SINGLE JSON LINE!\n");
+        exit(1);
+    }
+}
+
+// The entry points of the original API keep their signatures
+void check_plain_api(void)
+{
+    Json_Result results[] = {
+        parse_json_number(&memory, TSTR("-1.5e3")),
+        parse_json_string(&memory, TSTR("\"a\\nb\"")),
+        parse_json_array(&memory, TSTR("[1, [2]]"), 0),
+        parse_json_object(&memory, TSTR("{\"a\": {}}"), 0),
+        parse_json_value_with_depth(&memory, TSTR("[[[]]]"), JSON_DEPTH_MAX_LIMIT - 3),
+    };
+    const Json_Type types[] = {JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT, JSON_ARRAY};
+
+    for (size_t i = 0; i < ARRAY_SIZE(results); ++i) {
+        if (results[i].is_error || results[i].value.type != types[i] || results[i].rest.len != 0) {
+            fprintf(stderr, "FAILED WITH THE PLAIN API CASE %zu!\n", i);
+            exit(1);
+        }
+    }
+
+    if (!parse_json_value_with_depth(&memory, TSTR("[[[]]]"), JSON_DEPTH_MAX_LIMIT - 2).is_error) {
+        fprintf(stderr, "FAILED WITH THE PLAIN API DEPTH LIMIT!\n");
+        exit(1);
+    }
+
+    // The SAX and the cells parsers take the same number of levels from
+    // the stack
+    Json_Frame stack[3];
+    Json_Options options = {0};
+    options.stack = stack;
+    Json_Sax sax = {0};
+    for (size_t capacity = 1; capacity <= ARRAY_SIZE(stack); ++capacity) {
+        options.stack_capacity = capacity;
+        Json_Result deep = parse_json_sax(&memory, TSTR("[{\"a\": []}]"), &options, &sax);
+        if (deep.is_error != (capacity < 3)) {
+            fprintf(stderr, "FAILED WITH THE SAX DEPTH LIMIT %zu!\n", capacity);
+            exit(1);
+        }
+
+        Json_Cell cell;
+        Tzozen_Memory_Mark mark = tzozen_memory_save(&memory);
+        Tzozen_Str deep_source = TSTR("[{\"a long key that needs the memory\": []}]");
+        deep = parse_json_cells(&memory, &tape_memory, deep_source, &options, &cell);
+        if (deep.is_error != (capacity < 3)
+            || (deep.is_error && (memory.buffer != mark.buffer || memory.size != mark.size))) {
+            fprintf(stderr, "FAILED WITH THE CELLS DEPTH LIMIT %zu!\n", capacity);
+            exit(1);
+        }
+    }
+}
+
+const char paths_document[] =
+    "{\"user\": {\"id\": 7, \"name\": \"x\"},"
+    " \"a~b\": 1, \"c/d\": 2,"
+    " \"list\": [10, [20, 21], 30],"
+    " \"a\": [{\"b\": 1}, {\"c\": 2}, {\"b\": [3]}, 4],"
+    " \"skipped\": {\"deep\": [[[{\"b\": 5}]]]}}";
+
+typedef struct {
+    const char *path;
+    // NULL when nothing matches the path
+    const char *expected;
+} Path_Case;
+
+const Path_Case path_cases[] = {
+    {"/user/id", "7"},
+    {"user.name", "\"x\""},
+    {"/a~0b", "1"},
+    {"/c~1d", "2"},
+    {"/list/1/0", "20"},
+    {"list.2", "30"},
+    {"/list/3", NULL},
+    {"/user/missing", NULL},
+    {"/a/*/b", "[1, [3]]"},
+    {"/user/id/x", NULL},
+    {"/a/3", "4"},
+};
+
+void check_paths(void)
+{
+    Json_Path paths[ARRAY_SIZE(path_cases)];
+    memset(paths, 0, sizeof(paths));
+    for (size_t i = 0; i < ARRAY_SIZE(path_cases); ++i) {
+        paths[i].path = tzozen_str(strlen(path_cases[i].path), path_cases[i].path);
+    }
+
+    Tzozen_Str source = tzozen_str(strlen(paths_document), paths_document);
+    Json_Result result = parse_json_paths(&memory, source, paths, ARRAY_SIZE(paths), NULL);
+    if (result.is_error || result.rest.len != 0) {
+        fprintf(stderr, "FAILED TO PROJECT THE PATHS DOCUMENT!\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(path_cases); ++i) {
+        const Path_Case *c = &path_cases[i];
+        int failed = paths[i].found != (c->expected != NULL);
+        if (!failed && c->expected != NULL) {
+            Json_Result expected = parse_json_value(&memory, tzozen_str(strlen(c->expected), c->expected));
+            failed = expected.is_error || !json_value_equals(paths[i].value, expected.value);
+        }
+        if (failed) {
+            fprintf(stderr, "FAILED WITH THE PATH %s!\n", c->path);
+            exit(1);
+        }
+    }
+
+    // The errors inside of the matched values are found by the cursor
+    Json_Path broken = {.path = TSTR("/a/0")};
+    Tzozen_Str broken_source = TSTR("{\"a\": [1 2]}");
+    result = parse_json_paths(&memory, broken_source, &broken, 1, NULL);
+    if (!result.is_error || result.rest.data != broken_source.data + 9) {
+        fprintf(stderr, "FAILED TO REJECT THE BROKEN PATHS DOCUMENT!\n");
+        exit(1);
+    }
+}
+
+typedef struct {
+    // Only the first `len` bytes are written, the rest must stay out
+    const char *input;
+    size_t len;
+    const char *expected;
+} Escape_Case;
+
+const Escape_Case escape_cases[] = {
+    {"\x0b", 1, "\"\\u000b\""},
+    {"\x1f", 1, "\"\\u001f\""},
+    {"\x12", 1, "\"\\u0012\""},
+    {"\b\f\n\r\t", 5, "\"\\b\\f\\n\\r\\t\""},
+    {"\"\\", 2, "\"\\\"\\\\\""},
+    {"\xc3\"", 2, "\"\xc3\\\"\""},
+    {"\xc3\xa9", 2, "\"\xc3\xa9\""},
+    {"a\xe2\x82XYZ", 3, "\"a\xe2\x82\""},
+    {"\x7f", 1, "\"\x7f\""},
+};
+
+void check_escapes(void)
+{
+    char buffer[64];
+    for (size_t i = 0; i < ARRAY_SIZE(escape_cases); ++i) {
+        const Escape_Case *c = &escape_cases[i];
+        Json_Sink sink = json_sink_buffer(buffer, sizeof(buffer));
+        json_write_string(&sink, tzozen_str(c->len, c->input));
+        if (json_sink_flush(&sink) < 0
+            || sink.size != strlen(c->expected)
+            || memcmp(buffer, c->expected, sink.size) != 0) {
+            fprintf(stderr, "FAILED TO ESCAPE CASE %zu!\n", i);
+            fprintf(stderr, "Expected: %s\n", c->expected);
+            fprintf(stderr, "Actual:   %.*s\n", (int) sink.size, buffer);
+            exit(1);
+        }
+    }
+}
+
+// The offsets around the widths of the SWAR, SSE2 and AVX2 scans and
+// the 64-byte blocks of json_classify_block()
+const size_t scan_offsets[] = {0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65};
+
+void check_string_scan(void)
+{
+    char text[128];
+    const char stops[] = {'"', '\\', '\x01', '\x1f'};
+
+    for (size_t i = 0; i < ARRAY_SIZE(scan_offsets); ++i) {
+        size_t offset = scan_offsets[i];
+        for (size_t j = 0; j < ARRAY_SIZE(stops); ++j) {
+            memset(text, 'a', sizeof(text));
+            text[offset] = stops[j];
+            if (json_string_scan(text, sizeof(text)) != offset) {
+                fprintf(stderr, "FAILED TO SCAN 0x%02x AT %zu!\n", stops[j], offset);
+                exit(1);
+            }
+        }
+
+        // An escaped quote at the offset inside a literal
+        memset(text, 'a', sizeof(text));
+        text[0] = '"';
+        text[1 + offset] = '\\';
+        text[2 + offset] = '"';
+        text[sizeof(text) - 1] = '"';
+        Json_Result result = parse_json_value(&memory, tzozen_str(sizeof(text), text));
+        if (result.is_error
+            || result.value.string.len != sizeof(text) - 3
+            || result.value.string.data[offset] != '"') {
+            fprintf(stderr, "FAILED TO PARSE AN ESCAPED QUOTE AT %zu!\n", offset);
+            exit(1);
+        }
+
+        // Unescaped control characters are not allowed in the strings
+        text[1 + offset] = '\x01';
+        text[2 + offset] = 'a';
+        result = parse_json_value(&memory, tzozen_str(sizeof(text), text));
+        if (!result.is_error || result.rest.data != text + 1 + offset) {
+            fprintf(stderr, "FAILED TO REJECT A CONTROL CHARACTER AT %zu!\n", offset);
+            exit(1);
+        }
+    }
+}
+
+typedef struct {
+    const char *literal;
+    // The result of the checked conversion and its value if it is 0
+    int status;
+    int64_t value;
+    // The value of the saturating conversion
+    int64_t saturated;
+} Integer_Case;
+
+const Integer_Case integer_cases[] = {
+    {"9223372036854775807", 0, INT64_MAX, INT64_MAX},
+    {"9223372036854775808", -1, 0, INT64_MAX},
+    {"-9223372036854775808", 0, INT64_MIN, INT64_MIN},
+    {"-9223372036854775809", -1, 0, INT64_MIN},
+    {"1000000000000000000", 0, 1000000000000000000, 1000000000000000000},
+    {"1e18", 0, 1000000000000000000, 1000000000000000000},
+    {"1e19", -1, 0, INT64_MAX},
+    {"12345678901234567890", -1, 0, INT64_MAX},
+    {"-0.5e1", 0, -5, -5},
+    {"-0.5", 0, 0, 0},
+};
+
+void check_integers(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(integer_cases); ++i) {
+        const Integer_Case *c = &integer_cases[i];
+        Tzozen_Str literal = tzozen_str(strlen(c->literal), c->literal);
+
+        Json_Result result = parse_json_value(&memory, literal);
+        int64_t value = 0;
+        int status = result.is_error ? -2 : json_number_to_integer_checked(result.value.number, &value);
+        int failed = status != c->status
+            || (status == 0 && value != c->value)
+            || json_number_to_integer(result.value.number) != c->saturated;
+
+        // Only the plain integers go through the string conversion
+        if (strpbrk(c->literal, ".eE") == NULL) {
+            value = 0;
+            status = tzozen_str_stoi64_checked(literal, &value);
+            failed = failed
+                || status != c->status
+                || (status == 0 && value != c->value)
+                || tzozen_str_stoi64(literal) != c->saturated;
+        }
+
+        if (failed) {
+            fprintf(stderr, "FAILED TO CONVERT %s TO AN INTEGER!\n", c->literal);
+            exit(1);
+        }
+    }
+}
+
 int main()
 {
     DIR *testing_dir = opendir(TESTING_FOLDER);
@@ -115,6 +1094,9 @@ int main()
 
         printf("%s\n", json_filepath);
 
+        tzozen_memory_reset(&memory);
+        tzozen_memory_reset(&tape_memory);
+
         Tzozen_Str source = read_file_as_string(json_filepath);
         Json_Result result = parse_json_value(&memory, source);
         if (result.is_error) {
@@ -138,9 +1120,141 @@ int main()
 
             exit(1);
         }
+
+        check_numbers(result.value);
+
+        Json_Options measure_options = {0};
+        check_measure(source, measure_options, "THE DEFAULT OPTIONS");
+        measure_options.bytes = &memory;
+        check_measure(source, measure_options, "THE BYTES MEMORY");
+        measure_options.bytes = NULL;
+        measure_options.borrow_source = 1;
+        measure_options.finalize_containers = 1;
+        measure_options.hash_threshold = 2;
+        check_measure(source, measure_options, "THE CONTAINER OPTIONS");
+
+        Tzozen_Memory_Mark mark = tzozen_memory_save(&memory);
+        Json_Result truncated = parse_json_value(&memory, tzozen_str_take(source, source.len / 2));
+        if (truncated.is_error && (memory.buffer != mark.buffer || memory.size != mark.size)) {
+            fprintf(stderr, "FAILED! The memory of a failed parse is not given back\n");
+            exit(1);
+        }
+
+        Json_Options options = {0};
+        options.finalize_containers = 1;
+        options.hash_threshold = 1;
+        options.hash_seed = (Json_Hash_Seed) {0x0706050403020100, 0x0f0e0d0c0b0a0908};
+        Json_Intern intern;
+        if (json_intern_init(&memory, &intern, 1024, options.hash_seed) < 0) {
+            fprintf(stderr, "%s: Could not create the intern table\n", json_filepath);
+            exit(1);
+        }
+        intern.max_value_len = 16;
+        options.intern = &intern;
+        result = parse_json_value_with_options(&memory, source, &options);
+        check_result(result, source, *dump_index, "THE INTERNED STRINGS");
+        check_containers(result.value);
+
+        options = (Json_Options) {0};
+        options.borrow_source = 1;
+        Json_Frame stack[64];
+        options.stack = stack;
+        options.stack_capacity = ARRAY_SIZE(stack);
+        check_result(parse_json_value_with_options(&memory, source, &options),
+                     source, *dump_index, "THE BORROWED SOURCE");
+
+        check_sax(source, *dump_index);
+        check_sink(*dump_index);
+        check_reformat(source, *dump_index);
+
+        Json_Result skipped = json_skip_value(source);
+        if (skipped.is_error || !cursor_equals(skipped.value.string, *dump_index)) {
+            fprintf(stderr, "FAILED WITH THE CURSOR!\n");
+            exit(1);
+        }
+
+        Json_Path paths[] = {{.path = TSTR("")}, {.path = TSTR("/*")}};
+        Json_Result projected = parse_json_paths(&memory, source, paths, ARRAY_SIZE(paths), NULL);
+        Json_Value children = json_array_empty();
+        if (dump_index->type == JSON_ARRAY) {
+            children = *dump_index;
+        } else if (dump_index->type == JSON_OBJECT) {
+            FOR_JSON (Json_Object, elem, dump_index->object) {
+                json_array_push(&memory, &children.array, elem->value);
+            }
+        }
+        if (projected.is_error
+            || !paths[0].found
+            || !json_value_equals(paths[0].value, *dump_index)
+            || !json_value_equals(paths[1].value, children)) {
+            fprintf(stderr, "FAILED WITH THE PATHS!\n");
+            exit(1);
+        }
+
+        if (dump_index->type == JSON_ARRAY) {
+            Tzozen_Str slices[3];
+            size_t slices_count = 0;
+            Json_Result split = json_array_split(source, slices, ARRAY_SIZE(slices), &slices_count);
+            Json_Array array = {0};
+            for (size_t i = 0; !split.is_error && i < slices_count; ++i) {
+                split = parse_json_elements(&memory, slices[i], NULL);
+                if (!split.is_error) json_array_concat(&array, split.value.array);
+            }
+            split.value = json_array(array);
+            check_result(split, source, *dump_index, "THE ARRAY SPLIT");
+        }
+
+        // One byte at a time hits every possible split of the tokens,
+        // the random chunks (0) the runs of them within a chunk
+        const size_t push_chunks[] = {1, 0};
+        for (size_t i = 0; i < ARRAY_SIZE(push_chunks); ++i) {
+            Json_Push_Parser parser;
+            if (json_push_init(&parser, &memory, NULL) < 0) {
+                fprintf(stderr, "%s: Could not create the push parser\n", json_filepath);
+                exit(1);
+            }
+            if (push_source(&parser, source, push_chunks[i]) != JSON_PUSH_DONE) {
+                fprintf(stderr, "FAILED WITH THE PUSH PARSER!\n");
+                fprintf(stderr, "%s:%zu: %s\n", json_filepath, parser.position, parser.message);
+                exit(1);
+            }
+            result.is_error = 0;
+            result.value = parser.value;
+            check_result(result, source, *dump_index, "THE PUSH PARSER");
+        }
+
+        options = (Json_Options) {0};
+        Json_Tape tape;
+        Json_Result tape_result = parse_json_tape(&memory, &tape_memory, source, &options, &tape);
+        if (tape_result.is_error) {
+            fprintf(stderr, "FAILED WITH THE TAPE!\n");
+            print_json_error(stderr, tape_result, source, json_filepath);
+            exit(1);
+        }
+        if (json_tape_skip(tape, 0) != tape.size || !json_tape_equals(tape, 0, *dump_index)) {
+            fprintf(stderr, "FAILED WITH THE TAPE!\n");
+            exit(1);
+        }
+
+        check_cells(source, *dump_index, NULL, "THE DEFAULT OPTIONS");
+        options = (Json_Options) {0};
+        options.borrow_source = 1;
+        check_cells(source, *dump_index, &options, "THE BORROWED SOURCE");
     }
 
     closedir(testing_dir);
 
+    check_plain_api();
+    check_push_errors();
+    check_split_errors();
+    check_lines();
+    check_integers();
+    check_string_scan();
+    check_escapes();
+    check_paths();
+
+    tzozen_memory_free(&memory);
+    tzozen_memory_free(&tape_memory);
+
     return 0;
 }